@@ -1,6 +1,18 @@
 #pragma once
 #include "gtest/gtest.h"
 #include "zpp_bits.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 inline std::string encode_hex(auto && view)
 {
@@ -20,3 +32,201 @@ inline std::string encode_hex(auto && view)
 
     return hex;
 }
+
+// The bytes of a sequence of segments, such as the writes a sink received
+// or the segments of a gathered output, joined together.
+inline std::vector<std::byte> join_segments(auto && segments)
+{
+    std::vector<std::byte> data;
+    for (auto && segment : segments) {
+        data.insert(data.end(), segment.begin(), segment.end());
+    }
+    return data;
+}
+
+// Collects what the sink receives, one entry per call.
+struct collect
+{
+    zpp::bits::errc operator()(std::span<const std::byte> bytes)
+    {
+        writes.emplace_back(bytes.begin(), bytes.end());
+        return {};
+    }
+
+    std::vector<std::size_t> sizes() const
+    {
+        std::vector<std::size_t> sizes;
+        for (auto & write : writes) {
+            sizes.push_back(write.size());
+        }
+        return sizes;
+    }
+
+    std::vector<std::vector<std::byte>> writes;
+};
+
+// Hands out at most `chunk` bytes per call, and counts the calls.
+struct chunked
+{
+    std::size_t operator()(std::span<std::byte> bytes)
+    {
+        ++calls;
+        largest = std::max(largest, bytes.size());
+        auto count = std::min({bytes.size(), chunk, data.size() - position});
+        std::copy_n(data.begin() + position, count, bytes.begin());
+        position += count;
+        return count;
+    }
+
+    std::vector<std::byte> data;
+    std::size_t chunk = 7;
+    std::size_t position = 0;
+    std::size_t calls = 0;
+    std::size_t largest = 0;
+};
+
+// The bytes that writing the size of `items` and then the elements one at
+// a time produces, to compare the bytes of a bulk write against.
+inline std::vector<std::byte> one_by_one(auto && items, auto... options)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out out{data, options...};
+    out(std::uint32_t(items.size())).or_throw();
+    for (auto & item : items) {
+        out(item).or_throw();
+    }
+    return data;
+}
+
+// Writes the items that `make_items` makes for each of `counts`, expecting
+// the bytes that writing them one at a time produces, and reads them back.
+inline void round_trip_one_by_one(auto make_items,
+                                  std::initializer_list<std::size_t> counts,
+                                  auto... options)
+{
+    for (auto count : counts) {
+        auto items = make_items(count);
+
+        auto [data, in, out] = zpp::bits::data_in_out(options...);
+        out(items).or_throw();
+        EXPECT_EQ(data, one_by_one(items, options...));
+
+        std::remove_cvref_t<decltype(items)> restored;
+        in(restored).or_throw();
+        EXPECT_EQ(restored, items);
+        EXPECT_EQ(in.position(), data.size());
+    }
+}
+
+// Objects of every kind of member, to serialize in bulk.
+namespace fixtures
+{
+struct person
+{
+    std::string name;
+    std::vector<std::int32_t> numbers;
+    zpp::bits::vint64_t id;
+    std::map<std::string, std::uint16_t> tags;
+};
+
+inline auto people()
+{
+    std::vector<person> people;
+    for (int i = 0; i < 100; ++i) {
+        people.push_back({std::string(i, 'a'),
+                          {i, i + 1, i + 2},
+                          std::int64_t{i} << 40,
+                          {{"tag", std::uint16_t(i)}}});
+    }
+    return people;
+}
+
+struct record
+{
+    std::uint32_t id{};
+    std::string name;
+    std::vector<std::byte> payload;
+};
+
+inline auto records()
+{
+    std::vector<record> records;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        records.push_back({i,
+                           "record " + std::to_string(i),
+                           std::vector<std::byte>(i % 17, std::byte(i))});
+    }
+    return records;
+}
+} // namespace fixtures
+
+// Counts the allocations it makes and the elements it is asked to value
+// initialize. The counts are shared by every rebound copy, such as the one
+// that a container allocates its nodes with.
+struct allocation_counts
+{
+    inline static std::size_t allocations = 0;
+    inline static std::size_t constructed = 0;
+};
+
+template <typename Type>
+struct counting_allocator : std::allocator<Type>, allocation_counts
+{
+    using value_type = Type;
+
+    counting_allocator() = default;
+
+    template <typename Other>
+    counting_allocator(const counting_allocator<Other> &)
+    {
+    }
+
+    template <typename Other>
+    struct rebind
+    {
+        using other = counting_allocator<Other>;
+    };
+
+    Type * allocate(std::size_t count)
+    {
+        ++allocations;
+        return std::allocator<Type>::allocate(count);
+    }
+
+    template <typename Other, typename... Arguments>
+    void construct(Other * pointer, Arguments &&... arguments)
+    {
+        if constexpr (!sizeof...(Arguments)) {
+            ++constructed;
+        }
+        ::new (static_cast<void *>(pointer))
+            Other(std::forward<Arguments>(arguments)...);
+    }
+};
+
+// Counts the allocations and deallocations it passes on to the heap.
+struct counting_resource : std::pmr::memory_resource
+{
+    void * do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void * pointer,
+                       std::size_t bytes,
+                       std::size_t alignment) override
+    {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource & other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+};
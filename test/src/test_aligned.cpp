@@ -0,0 +1,130 @@
+#include "test.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace test_aligned
+{
+
+struct matrix
+{
+    std::uint8_t rows{};
+    std::uint8_t columns{};
+    std::vector<double> values;
+};
+
+TEST(test_aligned, layout)
+{
+    auto [data, in, out] = zpp::bits::data_in_out(zpp::bits::aligned<>{});
+    out(std::uint8_t{1}, std::uint32_t{2}, std::uint8_t{3}, std::uint64_t{4})
+        .or_throw();
+
+    EXPECT_EQ(encode_hex(data),
+              "01000000"
+              "02000000"
+              "03000000"
+              "00000000"
+              "0400000000000000");
+
+    std::uint8_t a{};
+    std::uint32_t b{};
+    std::uint8_t c{};
+    std::uint64_t d{};
+    in(a, b, c, d).or_throw();
+    EXPECT_EQ(b, 2u);
+    EXPECT_EQ(d, 4u);
+    EXPECT_EQ(in.position(), data.size());
+}
+
+TEST(test_aligned, limited_alignment)
+{
+    auto [data, out] = zpp::bits::data_out(zpp::bits::aligned<4>{});
+    out(std::uint8_t{1}, std::uint64_t{2}).or_throw();
+
+    EXPECT_EQ(encode_hex(data),
+              "01000000"
+              "0200000000000000");
+}
+
+TEST(test_aligned, typed_views)
+{
+    auto [data, in, out] = zpp::bits::data_in_out(zpp::bits::aligned<>{});
+    out(matrix{2, 3, {1, 2, 3, 4, 5, 6}}, std::string("name"),
+        std::vector<double>{7, 8})
+        .or_throw();
+
+    // Two bytes, then the size of the values, then the values from 8.
+    EXPECT_EQ(data.size(), 8u + 6 * 8 + 4 + 4 + 4 + 4 + 2 * 8);
+
+    std::uint8_t rows{};
+    std::uint8_t columns{};
+    std::span<const double> values;
+    std::string name;
+    std::span<const double> more;
+
+    zpp::bits::in view{data, zpp::bits::aligned<>{}};
+    view(rows, columns, values, name, more).or_throw();
+    EXPECT_EQ(rows, 2);
+    EXPECT_EQ(columns, 3);
+    ASSERT_EQ(values.size(), 6u);
+    EXPECT_EQ(values[5], 6.0);
+    EXPECT_EQ(values.data(),
+              reinterpret_cast<const double *>(data.data() + 8));
+    ASSERT_EQ(more.size(), 2u);
+    EXPECT_EQ(more[1], 8.0);
+
+    matrix restored;
+    std::string text;
+    std::vector<double> rest;
+    in(restored, text, rest).or_throw();
+    EXPECT_EQ(restored.values, (std::vector<double>{1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(text, "name");
+    EXPECT_EQ(rest, (std::vector<double>{7, 8}));
+    EXPECT_EQ(in.position(), data.size());
+}
+
+TEST(test_aligned, serialized_size)
+{
+    auto value = matrix{2, 3, {1, 2, 3}};
+    auto [data, out] = zpp::bits::data_out(zpp::bits::aligned<>{});
+    out(std::uint8_t{1}, value).or_throw();
+
+    EXPECT_EQ(
+        (zpp::bits::serialized_size<zpp::bits::aligned<>>(std::uint8_t{1},
+                                                          value)
+             .value()),
+        data.size());
+    EXPECT_EQ((zpp::bits::serialized_size<zpp::bits::aligned<>>(
+                   std::uint8_t{1}, std::uint64_t{2})
+                   .value()),
+              16u);
+}
+
+TEST(test_aligned, fixed_buffer)
+{
+    std::array<std::byte, 12> small{};
+    EXPECT_EQ((zpp::bits::out{small, zpp::bits::aligned<>{}}(
+                  std::uint8_t{1}, std::uint64_t{2})),
+              std::errc::result_out_of_range);
+
+    std::array<std::byte, 16> data{};
+    zpp::bits::out out{data, zpp::bits::aligned<>{}};
+    out(std::uint8_t{1}, std::uint64_t{2}).or_throw();
+    EXPECT_EQ(out.position(), 16u);
+
+    std::uint64_t value{};
+    zpp::bits::in in{data, zpp::bits::aligned<>{}};
+    in.position() = 1;
+    EXPECT_EQ(in(value), std::errc{});
+    EXPECT_EQ(value, 2u);
+
+    std::array<std::byte, 12> truncated{};
+    zpp::bits::in short_in{truncated, zpp::bits::aligned<>{}};
+    short_in.position() = 1;
+    EXPECT_EQ(short_in(value), std::errc::result_out_of_range);
+}
+
+} // namespace test_aligned
@@ -0,0 +1,129 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace test_associative_reuse
+{
+
+template <typename Type>
+using counting_map =
+    std::map<Type,
+             std::string,
+             std::less<Type>,
+             counting_allocator<std::pair<const Type, std::string>>>;
+
+static std::map<int, std::string> numbers(int first, int count)
+{
+    std::map<int, std::string> numbers;
+    for (int i = first; i < first + count; ++i) {
+        numbers.emplace(i, std::to_string(i));
+    }
+    return numbers;
+}
+
+TEST(test_associative_reuse, map_nodes_are_reused)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(numbers(100, 50)).or_throw();
+
+    counting_map<int> restored;
+    for (auto & [key, value] : numbers(0, 80)) {
+        restored.emplace(key, value);
+    }
+
+    counting_allocator<int>::allocations = 0;
+    in(restored).or_throw();
+    EXPECT_EQ(counting_allocator<int>::allocations, 0u);
+    EXPECT_EQ(restored.size(), 50u);
+    EXPECT_EQ(restored.begin()->first, 100);
+    EXPECT_EQ(restored.rbegin()->second, "149");
+}
+
+TEST(test_associative_reuse, more_elements_than_nodes)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(numbers(0, 30)).or_throw();
+
+    std::map<int, std::string> restored = numbers(1000, 10);
+    in(restored).or_throw();
+    EXPECT_EQ(restored, numbers(0, 30));
+}
+
+TEST(test_associative_reuse, set_and_multimap)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::set<std::string>{"a", "b", "c"},
+        std::multimap<int, int>{{1, 3}, {1, 2}, {0, 1}})
+        .or_throw();
+
+    std::set<std::string> set{"x", "y", "z", "w"};
+    std::multimap<int, int> multimap{{5, 5}};
+    in(set, multimap).or_throw();
+    EXPECT_EQ(set, (std::set<std::string>{"a", "b", "c"}));
+    EXPECT_EQ(multimap, (std::multimap<int, int>{{0, 1}, {1, 3}, {1, 2}}));
+}
+
+TEST(test_associative_reuse, comparator_is_kept)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::map<int, int>{{1, 1}, {2, 2}, {3, 3}}).or_throw();
+
+    auto descending = [](int left, int right) { return left > right; };
+    std::map<int, int, std::function<bool(int, int)>> restored{descending};
+    restored.emplace(7, 7);
+    in(restored).or_throw();
+    EXPECT_EQ(restored.size(), 3u);
+    EXPECT_EQ(restored.begin()->first, 3);
+}
+
+TEST(test_associative_reuse, unordered)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    std::unordered_map<int, std::string> map;
+    for (auto & [key, value] : numbers(0, 1000)) {
+        map.emplace(key, value);
+    }
+    out(map, std::unordered_set<int>{1, 2, 3}).or_throw();
+
+    std::unordered_map<int, std::string> restored{{-1, "-1"}};
+    std::unordered_set<int> set{4, 5};
+    in(restored, set).or_throw();
+    EXPECT_EQ(restored, map);
+    EXPECT_GE(restored.bucket_count(), 1000u);
+    EXPECT_EQ(set, (std::unordered_set<int>{1, 2, 3}));
+}
+
+TEST(test_associative_reuse, size_beyond_data)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::uint32_t{0xffffffff}, 1, 2).or_throw();
+
+    std::unordered_map<int, int> restored;
+    EXPECT_EQ(in(restored), std::errc::result_out_of_range);
+    EXPECT_LT(restored.bucket_count(), 1000u);
+}
+
+TEST(test_associative_reuse, other_memory_resource)
+{
+    auto [data, out] = zpp::bits::data_out();
+    out(numbers(0, 20)).or_throw();
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::map<int, std::pmr::string> restored;
+    restored.emplace(1, "1");
+    zpp::bits::in{data, zpp::bits::memory_resource{&arena}}(restored)
+        .or_throw();
+    EXPECT_EQ(restored.size(), 20u);
+    EXPECT_EQ(restored.get_allocator().resource(), &arena);
+    EXPECT_EQ(restored.at(19), "19");
+}
+
+} // namespace test_associative_reuse
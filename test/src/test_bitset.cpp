@@ -1,5 +1,7 @@
 #include "test.h"
 #include <bitset>
+#include <cstddef>
+#include <vector>
 
 namespace test_bitset
 {
@@ -18,4 +20,51 @@ TEST(test_bitset, sanity)
     EXPECT_EQ(o, i);
 }
 
+TEST(test_bitset, word)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    std::bitset<44> o(0x0ab'cdef'1234ull);
+    out(o).or_throw();
+    EXPECT_EQ(encode_hex(data), "3412efcdab00");
+
+    std::bitset<44> i;
+    i.set();
+    in(i).or_throw();
+    EXPECT_EQ(o, i);
+}
+
+TEST(test_bitset, large)
+{
+    std::bitset<1000> o;
+    for (std::size_t i = 0; i < o.size(); i += 7) {
+        o.set(i);
+    }
+    o.set(999);
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(o).or_throw();
+    EXPECT_EQ(out.position(), 125u);
+    EXPECT_EQ(data[0], std::byte{0b1000'0001});
+    EXPECT_EQ(data[124], std::byte{0b1000'0100});
+
+    std::bitset<1000> i;
+    i.set(1);
+    in(i).or_throw();
+    EXPECT_EQ(o, i);
+}
+
+TEST(test_bitset, padding_bits_are_ignored)
+{
+    std::vector<std::byte> data{std::byte{0xff}, std::byte{0xff}};
+
+    std::bitset<12> small;
+    zpp::bits::in{data}(small).or_throw();
+    EXPECT_EQ(small.count(), 12u);
+
+    std::vector<std::byte> large_data(9, std::byte{0xff});
+    std::bitset<70> large;
+    zpp::bits::in{large_data}(large).or_throw();
+    EXPECT_EQ(large.count(), 70u);
+}
+
 } // namespace test_bitset
@@ -0,0 +1,117 @@
+#include "test.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace test_bulk_byteswap
+{
+
+enum class color : std::uint32_t
+{
+    red = 0x11223344,
+    green = 0x55667788,
+};
+
+template <typename Type>
+static std::vector<Type> numbers(std::size_t count)
+{
+    std::vector<Type> numbers(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        numbers[i] = Type(0x0102030405060708ull * (i + 1));
+    }
+    return numbers;
+}
+
+TEST(test_bulk_byteswap, vector_round_trip)
+{
+    // Counts that leave every possible tail after whole registers.
+    std::initializer_list<std::size_t> counts = {
+        0, 1, 3, 7, 8, 15, 16, 17, 33, 1000};
+    constexpr auto big = zpp::bits::endian::big{};
+    round_trip_one_by_one(numbers<std::uint16_t>, counts, big);
+    round_trip_one_by_one(numbers<std::int32_t>, counts, big);
+    round_trip_one_by_one(numbers<std::uint64_t>, counts, big);
+    round_trip_one_by_one(numbers<float>, counts, big);
+    round_trip_one_by_one(numbers<double>, counts, big);
+}
+
+TEST(test_bulk_byteswap, hex)
+{
+    auto [data, out] = zpp::bits::data_out(zpp::bits::endian::big{});
+    out(std::array<std::uint16_t, 2>{0x1122, 0x3344},
+        std::vector<std::uint32_t>{0x11223344, 0x55667788},
+        std::array{color::red, color::green})
+        .or_throw();
+
+    EXPECT_EQ(encode_hex(data),
+              "11223344"
+              "00000002"
+              "1122334455667788"
+              "1122334455667788");
+
+    std::array<std::uint16_t, 2> shorts{};
+    std::vector<std::uint32_t> words;
+    std::array<color, 2> colors{};
+    zpp::bits::in{data, zpp::bits::endian::big{}}(shorts, words, colors)
+        .or_throw();
+    EXPECT_EQ(shorts[1], 0x3344);
+    EXPECT_EQ(words[1], 0x55667788u);
+    EXPECT_EQ(colors[1], color::green);
+}
+
+TEST(test_bulk_byteswap, other_way_around)
+{
+    auto items = numbers<std::uint32_t>(21);
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data, zpp::bits::endian::swapped{}}(
+        zpp::bits::unsized(items))
+        .or_throw();
+
+    std::vector<std::uint32_t> restored(items.size());
+    zpp::bits::in{data}(zpp::bits::unsized(restored)).or_throw();
+    for (auto & item : restored) {
+        item = (item >> 24) | ((item >> 8) & 0xff00) |
+               ((item << 8) & 0xff0000) | (item << 24);
+    }
+    EXPECT_EQ(restored, items);
+}
+
+TEST(test_bulk_byteswap, through_sink_and_source)
+{
+    auto items = numbers<std::uint64_t>(100);
+
+    zpp::bits::sink_buffer sink{collect{}, 16};
+    zpp::bits::out{sink, zpp::bits::endian::big{}}(items).or_throw();
+    auto data = join_segments(sink.sink().writes);
+    EXPECT_EQ(data, one_by_one(items, zpp::bits::endian::big{}));
+
+    zpp::bits::source_buffer source{chunked{data}, 16};
+    std::vector<std::uint64_t> restored;
+    zpp::bits::in{source, zpp::bits::endian::big{}}(restored).or_throw();
+    EXPECT_EQ(restored, items);
+}
+
+constexpr auto constant_round_trip()
+{
+    std::array<std::byte, 0x100> data{};
+    auto [in, out] = zpp::bits::in_out(data, zpp::bits::endian::swapped{});
+    out(std::array<std::uint32_t, 3>{1, 2, 3}).or_throw();
+
+    std::array<std::uint32_t, 3> restored{};
+    in(restored).or_throw();
+    return std::pair{restored, data[3]};
+}
+
+TEST(test_bulk_byteswap, constant_evaluation)
+{
+    static_assert(constant_round_trip().first ==
+                  std::array<std::uint32_t, 3>{1, 2, 3});
+    static_assert(constant_round_trip().second == std::byte{1});
+}
+
+} // namespace test_bulk_byteswap
@@ -0,0 +1,263 @@
+#include "test.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace test_bulk_varint
+{
+
+// Values of every encoded length, from one byte to ten.
+template <typename Varint>
+static std::vector<Varint> values(std::size_t count)
+{
+    using type = typename Varint::value_type;
+    std::vector<Varint> values;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto bits = i % (sizeof(type) * CHAR_BIT);
+        auto value = type(std::uint64_t(0x9e3779b97f4a7c15ull * (i + 1)) >>
+                          (63 - bits));
+        values.push_back(i % 3 ? value : type(-value));
+    }
+    values.push_back(std::numeric_limits<type>::max());
+    values.push_back(std::numeric_limits<type>::min());
+    return values;
+}
+
+TEST(test_bulk_varint, round_trip)
+{
+    std::initializer_list<std::size_t> counts = {0, 1, 7, 100, 1000};
+    round_trip_one_by_one(values<zpp::bits::vint32_t>, counts);
+    round_trip_one_by_one(values<zpp::bits::vuint32_t>, counts);
+    round_trip_one_by_one(values<zpp::bits::vsint32_t>, counts);
+    round_trip_one_by_one(values<zpp::bits::vint64_t>, counts);
+    round_trip_one_by_one(values<zpp::bits::vuint64_t>, counts);
+    round_trip_one_by_one(values<zpp::bits::vsint64_t>, counts);
+    round_trip_one_by_one(values<zpp::bits::varint<std::int16_t>>, counts);
+}
+
+TEST(test_bulk_varint, array)
+{
+    std::array<zpp::bits::vuint32_t, 3> items{1, 300, 0xffffffff};
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(items).or_throw();
+    EXPECT_EQ(encode_hex(data), "01ac02ffffffff0f");
+
+    std::array<zpp::bits::vuint32_t, 3> restored{};
+    in(restored).or_throw();
+    EXPECT_EQ(restored, items);
+}
+
+TEST(test_bulk_varint, boundary_values)
+{
+    using namespace zpp::bits::literals;
+
+    std::vector<zpp::bits::vuint64_t> items{
+        0, 127, 128, std::uint64_t{1} << 63, ~std::uint64_t{}};
+    auto expected = "05000000"
+                    "00"
+                    "7f"
+                    "8001"
+                    "80808080808080808001"
+                    "ffffffffffffffffff01"_decode_hex;
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(items).or_throw();
+    EXPECT_TRUE(std::equal(
+        data.begin(), data.end(), expected.begin(), expected.end()));
+
+    std::vector<zpp::bits::vuint64_t> restored;
+    in(restored).or_throw();
+    EXPECT_EQ(restored, items);
+}
+
+TEST(test_bulk_varint, zig_zag_boundary_values)
+{
+    using namespace zpp::bits::literals;
+
+    std::vector<zpp::bits::vsint64_t> items{
+        0,
+        -1,
+        1,
+        std::numeric_limits<std::int64_t>::max(),
+        std::numeric_limits<std::int64_t>::min()};
+    auto expected = "05000000"
+                    "00"
+                    "01"
+                    "02"
+                    "feffffffffffffffff01"
+                    "ffffffffffffffffff01"_decode_hex;
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(items).or_throw();
+    EXPECT_TRUE(std::equal(
+        data.begin(), data.end(), expected.begin(), expected.end()));
+
+    std::vector<zpp::bits::vsint64_t> restored;
+    in(restored).or_throw();
+    EXPECT_EQ(restored, items);
+}
+
+TEST(test_bulk_varint, fixed_room)
+{
+    auto items = values<zpp::bits::vuint64_t>(50);
+    auto expected = one_by_one(items);
+
+    std::vector<std::byte> data(expected.size());
+    zpp::bits::out{std::span{data}}(items).or_throw();
+    EXPECT_EQ(data, expected);
+
+    std::vector<std::byte> small(expected.size() - 1);
+    EXPECT_EQ(zpp::bits::out{std::span{small}}(items),
+              std::errc::result_out_of_range);
+}
+
+TEST(test_bulk_varint, span_keeps_bytes_past_the_end)
+{
+    auto items = values<zpp::bits::vuint64_t>(50);
+    auto expected = one_by_one(items);
+
+    // The bytes past the varints belong to the caller.
+    std::vector<std::byte> data(expected.size() + 16, std::byte{0xcc});
+    zpp::bits::out out{std::span{data}};
+    out(items).or_throw();
+    EXPECT_EQ(out.position(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), data.begin()));
+    EXPECT_TRUE(std::all_of(data.begin() + expected.size(),
+                            data.end(),
+                            [](auto byte) { return byte == std::byte{0xcc}; }));
+}
+
+TEST(test_bulk_varint, rewrite_keeps_bytes_past_the_end)
+{
+    auto items = values<zpp::bits::vuint64_t>(50);
+    auto expected = one_by_one(items);
+
+    // The bytes that the vector already holds belong to the caller.
+    std::vector<std::byte> data(expected.size() + 16, std::byte{0xcc});
+    zpp::bits::out out{data, zpp::bits::no_fit_size{}};
+    out.reset(0);
+    out(items).or_throw();
+    EXPECT_EQ(out.position(), expected.size());
+    EXPECT_EQ(data.size(), expected.size() + 16);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), data.begin()));
+    EXPECT_TRUE(std::all_of(data.begin() + expected.size(),
+                            data.end(),
+                            [](auto byte) { return byte == std::byte{0xcc}; }));
+
+    // So do the bytes written before moving the position back.
+    std::vector<std::byte> written;
+    zpp::bits::out rewritten{written};
+    rewritten(std::array<std::uint32_t, 4>{0xcccccccc, 0xcccccccc,
+                                           0xcccccccc, 0xcccccccc})
+        .or_throw();
+    rewritten.reset(0);
+    rewritten(std::array<zpp::bits::vuint32_t, 2>{1, 2}).or_throw();
+    EXPECT_EQ(rewritten.position(), 2u);
+    EXPECT_EQ(encode_hex(written),
+              "0102cccccccccccc"
+              "cccccccccccccccc");
+}
+
+struct packed_in_span
+{
+    using serialize = zpp::bits::pb_protocol;
+    std::vector<zpp::bits::vint32_t> integers;
+};
+
+TEST(test_bulk_varint, protobuf_packed_span_keeps_bytes_past_the_end)
+{
+    packed_in_span message{{1, 150, 300, -1}};
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected, zpp::bits::no_size{}}(message).or_throw();
+
+    std::vector<std::byte> data(expected.size() + 16, std::byte{0xcc});
+    zpp::bits::out out{std::span{data}, zpp::bits::no_size{}};
+    out(message).or_throw();
+    EXPECT_EQ(out.position(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), data.begin()));
+    EXPECT_TRUE(std::all_of(data.begin() + expected.size(),
+                            data.end(),
+                            [](auto byte) { return byte == std::byte{0xcc}; }));
+}
+
+TEST(test_bulk_varint, padded_encoding)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::uint32_t{2},
+        std::array{std::byte{0x96}, std::byte{0x81}, std::byte{0x80},
+                   std::byte{0x00}},
+        std::array<std::byte, 8>{std::byte{0x05}})
+        .or_throw();
+
+    std::vector<zpp::bits::vint32_t> restored;
+    in(restored).or_throw();
+    EXPECT_EQ(restored, (std::vector<zpp::bits::vint32_t>{150, 5}));
+}
+
+TEST(test_bulk_varint, too_long)
+{
+    using namespace zpp::bits::literals;
+
+    // A six byte varint of 32 bits, followed by more input, so that it is
+    // read a word at a time.
+    auto bytes = "01000000"
+                 "808080808001"
+                 "0101010101010101"_decode_hex;
+    std::vector<zpp::bits::vuint32_t> restored;
+    EXPECT_EQ(zpp::bits::in{bytes}(restored), std::errc::value_too_large);
+
+    // An eleven byte varint of 64 bits, at the end of the input.
+    auto long_bytes = "01000000"
+                      "8080808080808080808001"_decode_hex;
+    std::vector<zpp::bits::vuint64_t> long_restored;
+    EXPECT_EQ(zpp::bits::in{long_bytes}(long_restored),
+              std::errc::value_too_large);
+}
+
+TEST(test_bulk_varint, truncated)
+{
+    using namespace zpp::bits::literals;
+
+    // The second of two varints is cut short.
+    auto bytes = "02000000"
+                 "8001"
+                 "8080"_decode_hex;
+    std::vector<zpp::bits::vuint64_t> restored;
+    EXPECT_EQ(zpp::bits::in{bytes}(restored),
+              std::errc::result_out_of_range);
+
+    // Fewer varints than the size says, with enough input after the first
+    // one to read it a word at a time.
+    auto short_bytes = "03000000"
+                       "7f"
+                       "ffffffffffffffff01"_decode_hex;
+    EXPECT_EQ(zpp::bits::in{short_bytes}(restored),
+              std::errc::result_out_of_range);
+}
+
+struct packed
+{
+    using serialize = zpp::bits::pb_protocol;
+    std::vector<zpp::bits::vsint64_t> integers;
+    zpp::bits::vint32_t id;
+};
+
+TEST(test_bulk_varint, protobuf_packed)
+{
+    packed message{values<zpp::bits::vsint64_t>(500), 1337};
+
+    auto [data, in, out] = zpp::bits::data_in_out(zpp::bits::no_size{});
+    out(message).or_throw();
+
+    packed restored;
+    in(restored).or_throw();
+    EXPECT_EQ(restored.integers, message.integers);
+    EXPECT_EQ(restored.id, 1337);
+}
+
+} // namespace test_bulk_varint
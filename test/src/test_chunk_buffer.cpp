@@ -0,0 +1,178 @@
+#include "test.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace test_chunk_buffer
+{
+
+TEST(test_chunk_buffer, output_matches_vector_output)
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < 200; ++i) {
+        names.push_back(std::string(i % 31, 'n'));
+    }
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(names).or_throw();
+
+    zpp::bits::chunk_pool pool{256};
+    zpp::bits::chunk_buffer buffer{pool};
+    zpp::bits::out out{buffer};
+    out(names).or_throw();
+
+    auto segments = out.processed_data();
+    EXPECT_EQ(join_segments(segments), expected);
+    EXPECT_GT(segments.size(), expected.size() / 256);
+
+    // Every segment lies within a single chunk.
+    for (auto segment : segments) {
+        EXPECT_LE(segment.size(), 256u);
+    }
+}
+
+TEST(test_chunk_buffer, large_payload_is_split)
+{
+    std::vector<std::byte> payload(1000);
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = std::byte(i);
+    }
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(std::uint8_t{1}, payload, std::uint8_t{2})
+        .or_throw();
+
+    zpp::bits::chunk_pool pool{128};
+    zpp::bits::chunk_buffer buffer{pool};
+    zpp::bits::out out{buffer};
+    out(std::uint8_t{1}, payload, std::uint8_t{2}).or_throw();
+
+    auto segments = out.processed_data();
+    EXPECT_EQ(join_segments(segments), expected);
+
+    // The payload fills every chunk it crosses.
+    std::size_t full = 0;
+    for (auto segment : segments) {
+        full += segment.size() == 128;
+    }
+    EXPECT_GE(full, 6u);
+}
+
+TEST(test_chunk_buffer, calls_continue_in_the_same_chunk)
+{
+    zpp::bits::chunk_pool pool{256};
+    zpp::bits::chunk_buffer buffer{pool};
+    zpp::bits::out out{buffer};
+
+    out(std::uint32_t{1}).or_throw();
+    out(std::uint32_t{2}).or_throw();
+
+    auto segments = out.processed_data();
+    ASSERT_EQ(segments.size(), 2u);
+    EXPECT_EQ(segments[0].data() + segments[0].size(), segments[1].data());
+}
+
+struct pb_record
+{
+    zpp::bits::vint32_t id;
+    std::string name;
+
+    using serialize = zpp::bits::pb_protocol;
+};
+
+TEST(test_chunk_buffer, sized_messages_outgrowing_a_chunk)
+{
+    std::vector<pb_record> messages;
+    for (int i = 0; i < 20; ++i) {
+        messages.push_back({i, std::string(i * 10, 'x')});
+    }
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(messages).or_throw();
+
+    zpp::bits::chunk_pool pool{64};
+    zpp::bits::chunk_buffer buffer{pool};
+    zpp::bits::out out{buffer};
+    out(messages).or_throw();
+
+    auto data = join_segments(out.processed_data());
+    EXPECT_EQ(data, expected);
+
+    std::vector<pb_record> restored;
+    zpp::bits::in{data}(restored).or_throw();
+    ASSERT_EQ(restored.size(), messages.size());
+    EXPECT_EQ(restored.back().name, messages.back().name);
+}
+
+TEST(test_chunk_buffer, chunks_return_to_the_pool)
+{
+    zpp::bits::chunk_pool pool{128};
+    const std::byte * first{};
+    {
+        zpp::bits::chunk_buffer buffer{pool};
+        zpp::bits::out out{buffer};
+        out(std::uint32_t{1}).or_throw();
+        first = out.processed_data().front().data();
+    }
+
+    zpp::bits::chunk_buffer buffer{pool};
+    zpp::bits::out out{buffer};
+    out(std::uint32_t{2}).or_throw();
+    EXPECT_EQ(out.processed_data().front().data(), first);
+}
+
+TEST(test_chunk_buffer, clear_reuses_every_chunk)
+{
+    // Leaves enough room in the last chunk to not move on from it.
+    std::vector<std::byte> payload(940, std::byte{1});
+
+    zpp::bits::chunk_pool pool{128};
+    zpp::bits::chunk_buffer buffer{pool};
+    zpp::bits::out out{buffer};
+    out(payload).or_throw();
+
+    std::vector<const std::byte *> chunks;
+    for (auto segment : out.processed_data()) {
+        chunks.push_back(segment.data());
+    }
+    ASSERT_GE(chunks.size(), 8u);
+
+    buffer.clear();
+    out.reset();
+    out(payload).or_throw();
+
+    // The same chunks, drawn from the pool in the reverse order.
+    std::vector<const std::byte *> reused;
+    for (auto segment : out.processed_data()) {
+        reused.push_back(segment.data());
+    }
+    std::sort(chunks.begin(), chunks.end());
+    std::sort(reused.begin(), reused.end());
+    EXPECT_EQ(reused, chunks);
+}
+
+TEST(test_chunk_buffer, oversized_chunks_are_not_pooled)
+{
+    zpp::bits::chunk_pool pool{64};
+    const std::byte * oversized{};
+    {
+        zpp::bits::chunk_buffer buffer{pool};
+        zpp::bits::out out{buffer};
+        out(pb_record{1, std::string(200, 'x')}).or_throw();
+
+        auto segments = out.processed_data();
+        ASSERT_EQ(segments.size(), 1u);
+        EXPECT_GT(segments.front().size(), 64u);
+        oversized = segments.front().data();
+    }
+
+    // Only chunks of the pool size are handed out again.
+    zpp::bits::chunk_buffer buffer{pool};
+    zpp::bits::out out{buffer};
+    out(std::uint32_t{1}).or_throw();
+    EXPECT_NE(out.processed_data().front().data(), oversized);
+}
+
+} // namespace test_chunk_buffer
@@ -0,0 +1,96 @@
+#include "test.h"
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace test_default_init
+{
+
+using fixtures::people;
+using fixtures::person;
+
+TEST(test_default_init, growth_constructs_nothing)
+{
+    using allocator = zpp::bits::default_init_allocator<
+        std::byte,
+        counting_allocator<std::byte>>;
+
+    auto items = people();
+    std::vector<std::byte, allocator> data;
+    counting_allocator<std::byte>::constructed = 0;
+    zpp::bits::out{data}(items).or_throw();
+    EXPECT_EQ(counting_allocator<std::byte>::constructed, 0u);
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(items).or_throw();
+    EXPECT_TRUE(std::equal(
+        data.begin(), data.end(), expected.begin(), expected.end()));
+
+    std::vector<person> restored;
+    zpp::bits::in{data}(restored).or_throw();
+    EXPECT_EQ(restored.back().name, items.back().name);
+}
+
+TEST(test_default_init, copies_still_copy)
+{
+    std::vector<int, zpp::bits::default_init_allocator<int>> values(3, 7);
+    EXPECT_EQ(values[2], 7);
+    values.push_back(8);
+    EXPECT_EQ(values.back(), 8);
+}
+
+TEST(test_default_init, data_out)
+{
+    auto [data, out] =
+        zpp::bits::data_out<std::byte,
+                            zpp::bits::default_init_allocator<std::byte>>();
+    static_assert(
+        std::same_as<decltype(data),
+                     std::vector<std::byte,
+                                 zpp::bits::default_init_allocator<
+                                     std::byte>>>);
+    out(people()).or_throw();
+
+    std::vector<person> restored;
+    zpp::bits::in{data}(restored).or_throw();
+    EXPECT_EQ(restored.size(), 100u);
+}
+
+TEST(test_default_init, data_in_out)
+{
+    auto [data, in, out] =
+        zpp::bits::data_in_out<std::byte,
+                               zpp::bits::default_init_allocator<std::byte>>();
+    out(std::string("hello"), std::int32_t{7}).or_throw();
+
+    std::string text;
+    std::int32_t value{};
+    in(text, value).or_throw();
+    EXPECT_EQ(text, "hello");
+    EXPECT_EQ(value, 7);
+}
+
+TEST(test_default_init, string_output)
+{
+    auto items = people();
+    std::string data;
+    zpp::bits::out{data}(items).or_throw();
+
+    std::vector<person> restored;
+    zpp::bits::in{data}(restored).or_throw();
+    EXPECT_EQ(restored.back().numbers, items.back().numbers);
+}
+
+TEST(test_default_init, bitset_over_dirty_bytes)
+{
+    std::bitset<12> bits(0b1000'0000'0101);
+    std::vector<std::byte> data(2, std::byte{0xff});
+    zpp::bits::out{data}(bits).or_throw();
+    EXPECT_EQ(data[0], std::byte{0b0000'0101});
+    EXPECT_EQ(data[1], std::byte{0b0000'1000});
+}
+
+} // namespace test_default_init
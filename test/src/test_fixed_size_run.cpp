@@ -0,0 +1,169 @@
+#include "test.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace test_fixed_size_run
+{
+
+enum class color : std::uint8_t
+{
+    red,
+    green,
+};
+
+// Written as a single character, rather than as its bytes.
+enum class shade : std::uint32_t
+{
+    light = 'l',
+    dark = 'd',
+};
+
+constexpr auto serialize(auto & archive, shade & value)
+{
+    char letter = char(value);
+    auto result = archive(letter);
+    value = shade(letter);
+    return result;
+}
+
+constexpr auto serialize(auto & archive, const shade & value)
+{
+    return archive(char(value));
+}
+
+struct point
+{
+    std::int32_t x{};
+    std::int32_t y{};
+};
+
+struct message
+{
+    std::uint16_t kind{};
+    color tint{};
+    point origin;
+    std::string name;
+    double weight{};
+    std::int64_t id{};
+    std::vector<std::int32_t> values;
+    char tag{};
+};
+
+static message some_message()
+{
+    return {0x1234, color::green, {-1, 2}, "name", 1.5, -7, {1, 2, 3}, 'z'};
+}
+
+static std::vector<std::byte> item_by_item(auto & archive_options,
+                                           const message & value)
+{
+    std::vector<std::byte> data;
+    std::apply(
+        [&](auto... options) {
+            zpp::bits::out out{data, options...};
+            out(value.kind).or_throw();
+            out(value.tint).or_throw();
+            out(value.origin).or_throw();
+            out(value.name).or_throw();
+            out(value.weight).or_throw();
+            out(value.id).or_throw();
+            out(value.values).or_throw();
+            out(value.tag).or_throw();
+        },
+        archive_options);
+    return data;
+}
+
+TEST(test_fixed_size_run, same_bytes_as_item_by_item)
+{
+    auto value = some_message();
+    auto no_options = std::tuple{};
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(value).or_throw();
+    EXPECT_EQ(data, item_by_item(no_options, value));
+
+    message restored;
+    zpp::bits::in{data}(restored).or_throw();
+    EXPECT_EQ(restored.kind, 0x1234);
+    EXPECT_EQ(restored.tint, color::green);
+    EXPECT_EQ(restored.origin.x, -1);
+    EXPECT_EQ(restored.name, "name");
+    EXPECT_EQ(restored.weight, 1.5);
+    EXPECT_EQ(restored.id, -7);
+    EXPECT_EQ(restored.values, value.values);
+    EXPECT_EQ(restored.tag, 'z');
+}
+
+TEST(test_fixed_size_run, byte_order)
+{
+    auto value = some_message();
+    auto big = std::tuple{zpp::bits::endian::big{}};
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data, zpp::bits::endian::big{}}(value).or_throw();
+    EXPECT_EQ(data, item_by_item(big, value));
+    EXPECT_EQ(data[0], std::byte{0x12});
+    EXPECT_EQ(data[1], std::byte{0x34});
+
+    message restored;
+    zpp::bits::in{data, zpp::bits::endian::big{}}(restored).or_throw();
+    EXPECT_EQ(restored.origin.x, -1);
+    EXPECT_EQ(restored.id, -7);
+}
+
+TEST(test_fixed_size_run, items_in_one_call)
+{
+    std::array<std::byte, 14> data{};
+    zpp::bits::out out{data};
+    out(std::uint8_t{1}, std::uint32_t{2}, std::string("ab"), std::uint8_t{3})
+        .or_throw();
+    EXPECT_EQ(out.position(), 1u + 4u + 4u + 2u + 1u);
+    EXPECT_EQ(data[11], std::byte{3});
+}
+
+TEST(test_fixed_size_run, custom_serialize_is_not_fused)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out out{data};
+    out(std::uint16_t{1}, shade::dark, std::uint16_t{2}).or_throw();
+    ASSERT_EQ(data.size(), 2u + 1u + 2u);
+    EXPECT_EQ(data[2], std::byte{'d'});
+
+    std::uint16_t first{};
+    shade value{};
+    std::uint16_t second{};
+    zpp::bits::in{data}(first, value, second).or_throw();
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(value, shade::dark);
+    EXPECT_EQ(second, 2);
+}
+
+TEST(test_fixed_size_run, run_that_does_not_fit)
+{
+    std::array<std::byte, 4> data{};
+    zpp::bits::out out{data};
+    EXPECT_EQ(out(std::uint16_t{1}, std::uint32_t{2}, std::string("ab")),
+              std::errc::result_out_of_range);
+    EXPECT_EQ(out.position(), 0u);
+}
+
+TEST(test_fixed_size_run, constexpr_run)
+{
+    constexpr auto data = [] {
+        std::array<std::byte, 7> data{};
+        zpp::bits::out out{data};
+        out(std::uint8_t{1}, std::uint16_t{0x0302}, std::uint32_t{0x07060504})
+            .or_throw();
+        return data;
+    }();
+    static_assert(data[0] == std::byte{1});
+    static_assert(data[1] == std::byte{2});
+    static_assert(data[6] == std::byte{7});
+}
+
+} // namespace test_fixed_size_run
@@ -0,0 +1,374 @@
+#include "test.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if __has_include(<flat_map>)
+#include <flat_map>
+#endif
+#if __has_include(<flat_set>)
+#include <flat_set>
+#endif
+
+namespace test_flat_containers
+{
+
+// Enough of the interface of `std::flat_map` over sorted vectors for the
+// archives, counting the elements inserted one by one.
+template <typename Key,
+          typename Mapped,
+          typename Compare = std::less<Key>,
+          typename MappedContainer = std::vector<Mapped>>
+struct sorted_vector_map
+{
+    using key_type = Key;
+    using mapped_type = Mapped;
+    using value_type = std::pair<Key, Mapped>;
+    using key_compare = Compare;
+    using iterator = typename std::vector<Key>::iterator;
+
+    struct containers
+    {
+        std::vector<Key> keys;
+        MappedContainer values;
+    };
+
+    sorted_vector_map() = default;
+
+    sorted_vector_map(std::vector<Key> keys,
+                      MappedContainer values,
+                      const Compare & compare = Compare{}) :
+        m_compare(compare)
+    {
+        std::vector<std::size_t> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](auto left, auto right) {
+            return m_compare(keys[left], keys[right]);
+        });
+        for (auto index : order) {
+            if (m_containers.keys.empty() ||
+                m_compare(m_containers.keys.back(), keys[index])) {
+                m_containers.keys.push_back(std::move(keys[index]));
+                m_containers.values.push_back(std::move(values[index]));
+            }
+        }
+    }
+
+    std::pair<iterator, bool> insert(value_type value)
+    {
+        ++inserted;
+        auto position = std::lower_bound(
+            m_containers.keys.begin(), m_containers.keys.end(), value.first,
+            m_compare);
+        if (position != m_containers.keys.end() &&
+            !m_compare(value.first, *position)) {
+            return {position, false};
+        }
+        m_containers.values.insert(
+            m_containers.values.begin() +
+                (position - m_containers.keys.begin()),
+            std::move(value.second));
+        return {m_containers.keys.insert(position, std::move(value.first)),
+                true};
+    }
+
+    containers extract() &&
+    {
+        return std::move(m_containers);
+    }
+
+    void replace(std::vector<Key> && keys, MappedContainer && values)
+    {
+        m_containers.keys = std::move(keys);
+        m_containers.values = std::move(values);
+    }
+
+    const std::vector<Key> & keys() const
+    {
+        return m_containers.keys;
+    }
+
+    const MappedContainer & values() const
+    {
+        return m_containers.values;
+    }
+
+    Compare key_comp() const
+    {
+        return m_compare;
+    }
+
+    std::size_t size() const
+    {
+        return m_containers.keys.size();
+    }
+
+    auto begin()
+    {
+        return m_containers.keys.begin();
+    }
+
+    auto end()
+    {
+        return m_containers.keys.end();
+    }
+
+    containers m_containers;
+    Compare m_compare;
+    inline static std::size_t inserted = 0;
+};
+
+// Likewise for `std::flat_set`.
+template <typename Key, typename Compare = std::less<Key>>
+struct sorted_vector_set
+{
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using container_type = std::vector<Key>;
+    using iterator = typename container_type::const_iterator;
+
+    sorted_vector_set() = default;
+
+    sorted_vector_set(container_type elements,
+                      const Compare & compare = Compare{}) :
+        m_elements(std::move(elements)), m_compare(compare)
+    {
+        std::sort(m_elements.begin(), m_elements.end(), m_compare);
+        m_elements.erase(
+            std::unique(m_elements.begin(),
+                        m_elements.end(),
+                        [&](auto & left, auto & right) {
+                            return !m_compare(left, right);
+                        }),
+            m_elements.end());
+    }
+
+    std::pair<iterator, bool> insert(value_type value)
+    {
+        ++inserted;
+        auto position = std::lower_bound(
+            m_elements.begin(), m_elements.end(), value, m_compare);
+        if (position != m_elements.end() && !m_compare(value, *position)) {
+            return {position, false};
+        }
+        return {m_elements.insert(position, std::move(value)), true};
+    }
+
+    container_type extract() &&
+    {
+        return std::move(m_elements);
+    }
+
+    void replace(container_type && elements)
+    {
+        m_elements = std::move(elements);
+    }
+
+    Compare key_comp() const
+    {
+        return m_compare;
+    }
+
+    std::size_t size() const
+    {
+        return m_elements.size();
+    }
+
+    iterator begin() const
+    {
+        return m_elements.begin();
+    }
+
+    iterator end() const
+    {
+        return m_elements.end();
+    }
+
+    container_type m_elements;
+    Compare m_compare;
+    inline static std::size_t inserted = 0;
+};
+
+TEST(test_flat_containers, map_blocks)
+{
+    sorted_vector_map<std::uint32_t, std::uint16_t> map;
+    map.insert({3, 0x33});
+    map.insert({1, 0x11});
+    map.insert({2, 0x22});
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(map).or_throw();
+    EXPECT_EQ(encode_hex(data),
+              "03000000"
+              "010000000200000003000000"
+              "110022003300");
+
+    sorted_vector_map<std::uint32_t, std::uint16_t> restored;
+    restored.insert({7, 7});
+    sorted_vector_map<std::uint32_t, std::uint16_t>::inserted = 0;
+    in(restored).or_throw();
+    EXPECT_EQ(decltype(restored)::inserted, 0u);
+    EXPECT_EQ(restored.keys(), map.keys());
+    EXPECT_EQ(restored.values(), map.values());
+}
+
+TEST(test_flat_containers, map_of_strings)
+{
+    sorted_vector_map<std::string, std::vector<int>> map;
+    for (int i = 0; i < 100; ++i) {
+        map.insert({std::to_string(1000 + i), {i, i + 1}});
+    }
+
+    auto [data, in, out] = zpp::bits::data_in_out(zpp::bits::size_varint{});
+    out(map).or_throw();
+
+    sorted_vector_map<std::string, std::vector<int>> restored;
+    in(restored).or_throw();
+    EXPECT_EQ(restored.keys(), map.keys());
+    EXPECT_EQ(restored.values(), map.values());
+}
+
+// Can only be created by the archives, and counts how often.
+class made_by_archive
+{
+public:
+    using serialize = zpp::bits::members<1>;
+
+    made_by_archive(int value) : value(value)
+    {
+    }
+
+    bool operator==(const made_by_archive &) const = default;
+
+    int value;
+    inline static std::size_t made = 0;
+
+private:
+    friend zpp::bits::access;
+    made_by_archive() : value{}
+    {
+        ++made;
+    }
+};
+
+TEST(test_flat_containers, map_values_read_in_place)
+{
+    sorted_vector_map<int, made_by_archive> map;
+    for (int i = 0; i < 10; ++i) {
+        map.insert({i, made_by_archive{i * 10}});
+    }
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(map).or_throw();
+
+    sorted_vector_map<int, made_by_archive> restored;
+    restored.insert({7, made_by_archive{7}});
+    made_by_archive::made = 0;
+    in(restored).or_throw();
+    EXPECT_EQ(made_by_archive::made, 10u);
+    EXPECT_EQ(restored.keys(), map.keys());
+    EXPECT_EQ(restored.values(), map.values());
+}
+
+TEST(test_flat_containers, map_values_are_not_value_initialized)
+{
+    sorted_vector_map<std::uint32_t, std::byte> map;
+    for (std::uint32_t i = 0; i < 100; ++i) {
+        map.insert({i, std::byte(i)});
+    }
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(map).or_throw();
+
+    sorted_vector_map<std::uint32_t,
+                      std::byte,
+                      std::less<std::uint32_t>,
+                      std::vector<std::byte, counting_allocator<std::byte>>>
+        restored;
+    counting_allocator<std::byte>::constructed = 0;
+    in(restored).or_throw();
+    EXPECT_EQ(counting_allocator<std::byte>::constructed, 0u);
+    EXPECT_EQ(restored.keys(), map.keys());
+    EXPECT_TRUE(std::equal(restored.values().begin(),
+                           restored.values().end(),
+                           map.values().begin(),
+                           map.values().end()));
+}
+
+TEST(test_flat_containers, unsorted_input_is_sorted)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::uint32_t{4},
+        std::array<int, 4>{3, 1, 3, 2},
+        std::array<int, 4>{30, 10, 31, 20})
+        .or_throw();
+
+    sorted_vector_map<int, int> restored;
+    in(restored).or_throw();
+    EXPECT_EQ(restored.keys(), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(restored.values(), (std::vector<int>{10, 20, 30}));
+}
+
+TEST(test_flat_containers, set)
+{
+    sorted_vector_set<std::int64_t, std::greater<>> set;
+    for (std::int64_t i = 0; i < 1000; ++i) {
+        set.insert(i * 3);
+    }
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(set).or_throw();
+    EXPECT_EQ(data.size(), sizeof(std::uint32_t) + 1000 * sizeof(std::int64_t));
+
+    sorted_vector_set<std::int64_t, std::greater<>> restored;
+    decltype(restored)::inserted = 0;
+    in(restored).or_throw();
+    EXPECT_EQ(decltype(restored)::inserted, 0u);
+    EXPECT_EQ(restored.m_elements, set.m_elements);
+
+    // The same bytes read into a set of the other order are sorted again.
+    sorted_vector_set<std::int64_t> ascending;
+    in.reset();
+    in(ascending).or_throw();
+    EXPECT_EQ(ascending.m_elements.front(), 0);
+    EXPECT_EQ(ascending.m_elements.back(), 2997);
+}
+
+TEST(test_flat_containers, alloc_limit)
+{
+    sorted_vector_map<std::uint8_t, std::uint64_t> map;
+    for (int i = 0; i < 100; ++i) {
+        map.insert({std::uint8_t(i), std::uint64_t(i)});
+    }
+
+    auto [data, out] = zpp::bits::data_out();
+    out(map).or_throw();
+
+    sorted_vector_map<std::uint8_t, std::uint64_t> restored;
+    EXPECT_EQ((zpp::bits::in{data, zpp::bits::alloc_limit<200>{}}(restored)),
+              std::errc::message_size);
+}
+
+#if defined __cpp_lib_flat_map && defined __cpp_lib_flat_set
+TEST(test_flat_containers, standard)
+{
+    std::flat_map<int, std::string> map{{1, "a"}, {2, "b"}};
+    std::flat_set<int> set{5, 4, 3};
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(map, set).or_throw();
+
+    std::flat_map<int, std::string> restored_map;
+    std::flat_set<int> restored_set;
+    in(restored_map, restored_set).or_throw();
+    EXPECT_EQ(restored_map, map);
+    EXPECT_EQ(restored_set, set);
+}
+#endif
+
+} // namespace test_flat_containers
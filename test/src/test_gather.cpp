@@ -0,0 +1,154 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace test_gather
+{
+
+TEST(test_gather, payloads_from_the_threshold_are_referenced)
+{
+    std::vector<std::byte> small(15, std::byte{1});
+    std::vector<std::byte> large(16, std::byte{2});
+
+    zpp::bits::gather_buffer buffer{16};
+    zpp::bits::out out{buffer};
+    out(small, large, std::uint8_t{3}).or_throw();
+
+    // The size and bytes of the small payload and the size of the large
+    // one, then the large payload in place, then the last byte.
+    auto segments = buffer.segments(out.position());
+    ASSERT_EQ(segments.size(), 3u);
+    EXPECT_EQ(segments[0].data(), buffer.data());
+    EXPECT_EQ(segments[0].size(), 4u + 15 + 4);
+    EXPECT_EQ(segments[1].data(), large.data());
+    EXPECT_EQ(segments[1].size(), 16u);
+    EXPECT_EQ(segments[2].data(), buffer.data() + segments[0].size());
+    EXPECT_EQ(segments[2].size(), 1u);
+
+    EXPECT_EQ(out.position(), 4u + 15 + 4 + 1);
+    EXPECT_EQ(buffer.output_size(out.position()), out.position() + 16);
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(small, large, std::uint8_t{3}).or_throw();
+    EXPECT_EQ(join_segments(segments), expected);
+}
+
+TEST(test_gather, adjacent_references_leave_no_empty_segments)
+{
+    std::vector<std::byte> first(100, std::byte{1});
+    std::vector<std::byte> second(100, std::byte{2});
+
+    zpp::bits::gather_buffer buffer{16};
+    zpp::bits::out out{buffer};
+    out(zpp::bits::unsized(first), zpp::bits::unsized(second)).or_throw();
+
+    auto segments = buffer.segments(out.position());
+    ASSERT_EQ(segments.size(), 2u);
+    EXPECT_EQ(segments[0].data(), first.data());
+    EXPECT_EQ(segments[1].data(), second.data());
+    EXPECT_EQ(out.position(), 0u);
+}
+
+TEST(test_gather, small_payloads_are_copied)
+{
+    std::vector<std::string> names{"a", std::string(100, 'b'), "c"};
+
+    zpp::bits::gather_buffer buffer;
+    zpp::bits::out out{buffer};
+    out(names).or_throw();
+
+    auto segments = buffer.segments(out.position());
+    ASSERT_EQ(segments.size(), 1u);
+    EXPECT_EQ(segments.front().data(), buffer.data());
+    EXPECT_EQ(segments.front().size(), out.position());
+}
+
+struct pb_blob
+{
+    zpp::bits::vint32_t id;
+    std::vector<std::byte> payload;
+
+    using serialize = zpp::bits::pb_protocol;
+};
+
+TEST(test_gather, sized_messages_are_copied)
+{
+    pb_blob message{1, std::vector<std::byte>(1000, std::byte{1})};
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(message, message.payload).or_throw();
+
+    zpp::bits::gather_buffer buffer{16};
+    zpp::bits::out out{buffer};
+    out(message, message.payload).or_throw();
+
+    // The payload inside of the message is copied, the one after it is not.
+    auto segments = buffer.segments(out.position());
+    EXPECT_EQ(join_segments(segments), expected);
+    ASSERT_EQ(segments.size(), 2u);
+    EXPECT_EQ(segments.back().data(), message.payload.data());
+}
+
+TEST(test_gather, clear_starts_over)
+{
+    std::vector<std::byte> payload(100, std::byte{1});
+
+    zpp::bits::gather_buffer buffer{16};
+    zpp::bits::out out{buffer};
+    out(payload).or_throw();
+    ASSERT_EQ(buffer.segments(out.position()).size(), 2u);
+
+    buffer.clear();
+    out.reset();
+    out(std::uint32_t{7}).or_throw();
+
+    auto segments = buffer.segments(out.position());
+    ASSERT_EQ(segments.size(), 1u);
+    EXPECT_EQ(encode_hex(segments.front()), "07000000");
+    EXPECT_EQ(buffer.output_size(out.position()), 4u);
+}
+
+#if __has_include(<sys/uio.h>)
+TEST(test_gather, writev)
+{
+    std::vector<std::byte> first(300, std::byte{1});
+    std::vector<std::byte> second(500, std::byte{2});
+
+    zpp::bits::gather_buffer buffer{256};
+    zpp::bits::out out{buffer};
+    out(std::uint8_t{1}, first, std::uint8_t{2}, second).or_throw();
+
+    // One entry per segment, pointing at the same bytes.
+    auto segments = buffer.segments(out.position());
+    auto iovecs = buffer.iovecs(out.position());
+    ASSERT_EQ(iovecs.size(), segments.size());
+    for (std::size_t i = 0; i < iovecs.size(); ++i) {
+        EXPECT_EQ(iovecs[i].iov_base, segments[i].data());
+        EXPECT_EQ(iovecs[i].iov_len, segments[i].size());
+    }
+
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    auto expected = join_segments(segments);
+    ASSERT_EQ(::writev(fileno(file), iovecs.data(), int(iovecs.size())),
+              ssize_t(expected.size()));
+
+    std::vector<std::byte> data(expected.size());
+    std::rewind(file);
+    ASSERT_EQ(std::fread(data.data(), 1, data.size(), file), data.size());
+    std::fclose(file);
+
+    EXPECT_EQ(data, expected);
+}
+#endif
+
+} // namespace test_gather
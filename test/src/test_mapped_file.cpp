@@ -0,0 +1,153 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if ZPP_BITS_HAS_MMAP
+#include <unistd.h>
+
+namespace test_mapped_file
+{
+
+struct record
+{
+    std::uint32_t id{};
+    std::string_view name;
+    std::span<const char> payload;
+};
+
+// A file in the temporary directory that is removed at the end of the
+// test.
+struct temporary_file
+{
+    temporary_file()
+    {
+        char name[] = "/tmp/zpp_bits_mapped_XXXXXX";
+        auto fd = ::mkstemp(name);
+        EXPECT_GE(fd, 0);
+        ::close(fd);
+        path = name;
+    }
+
+    ~temporary_file()
+    {
+        std::remove(path.c_str());
+    }
+
+    void write(std::span<const std::byte> data)
+    {
+        auto file = std::fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        EXPECT_EQ(std::fwrite(data.data(), 1, data.size(), file),
+                  data.size());
+        std::fclose(file);
+    }
+
+    std::string path;
+};
+
+TEST(test_mapped_file, views_alias_the_mapping)
+{
+    auto items = fixtures::records();
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(items).or_throw();
+
+    temporary_file file;
+    file.write(data);
+
+    zpp::bits::mapped_file<char> mapping;
+    mapping.open(file.path.c_str()).or_throw();
+    ASSERT_EQ(mapping.size(), data.size());
+
+    std::vector<record> restored;
+    zpp::bits::in in{mapping};
+    in(restored).or_throw();
+    EXPECT_EQ(in.position(), mapping.size());
+
+    ASSERT_EQ(restored.size(), items.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        EXPECT_EQ(restored[i].id, items[i].id);
+        EXPECT_EQ(restored[i].name, items[i].name);
+        EXPECT_TRUE(std::equal(
+            restored[i].payload.begin(),
+            restored[i].payload.end(),
+            reinterpret_cast<const char *>(items[i].payload.data()),
+            reinterpret_cast<const char *>(items[i].payload.data()) +
+                items[i].payload.size()));
+    }
+
+    auto begin = mapping.data();
+    auto end = begin + mapping.size();
+    EXPECT_GE(restored.back().name.data(), begin);
+    EXPECT_LT(restored.back().name.data(), end);
+    EXPECT_GE(restored.back().payload.data(), begin);
+    EXPECT_LT(restored.back().payload.data(), end);
+}
+
+TEST(test_mapped_file, owning_types_are_copied_out)
+{
+    auto items = fixtures::records();
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(items).or_throw();
+
+    temporary_file file;
+    file.write(data);
+
+    zpp::bits::mapped_file mapping;
+    mapping.open(file.path.c_str(), zpp::bits::map_advice::willneed)
+        .or_throw();
+    mapping.advise(zpp::bits::map_advice::random, 100, 100)
+        .or_throw();
+
+    std::vector<fixtures::record> restored;
+    zpp::bits::in{mapping}(restored).or_throw();
+    ASSERT_EQ(restored.size(), items.size());
+    EXPECT_EQ(restored.back().name, items.back().name);
+    EXPECT_EQ(restored.back().payload, items.back().payload);
+}
+
+TEST(test_mapped_file, empty_file)
+{
+    temporary_file file;
+
+    zpp::bits::mapped_file mapping;
+    mapping.open(file.path.c_str()).or_throw();
+    EXPECT_EQ(mapping.size(), 0u);
+
+    std::uint32_t value{};
+    EXPECT_EQ(zpp::bits::in{mapping}(value), std::errc::result_out_of_range);
+}
+
+TEST(test_mapped_file, missing_file)
+{
+    zpp::bits::mapped_file mapping;
+    EXPECT_EQ(mapping.open("/nonexistent/zpp_bits"),
+              std::errc::no_such_file_or_directory);
+}
+
+TEST(test_mapped_file, move)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::uint32_t{1337}).or_throw();
+
+    temporary_file file;
+    file.write(data);
+
+    zpp::bits::mapped_file first;
+    first.open(file.path.c_str()).or_throw();
+
+    auto second = std::move(first);
+    EXPECT_EQ(first.data(), nullptr);
+    EXPECT_EQ(second.size(), sizeof(std::uint32_t));
+
+    std::uint32_t value{};
+    zpp::bits::in{second}(value).or_throw();
+    EXPECT_EQ(value, 1337u);
+}
+
+} // namespace test_mapped_file
+#endif
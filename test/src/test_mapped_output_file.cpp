@@ -0,0 +1,146 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if ZPP_BITS_HAS_MMAP
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace test_mapped_output_file
+{
+
+using fixtures::record;
+using fixtures::records;
+
+// A path in the temporary directory that is removed at the end of the
+// test.
+struct temporary_path
+{
+    temporary_path()
+    {
+        char name[] = "/tmp/zpp_bits_mapped_output_XXXXXX";
+        auto fd = ::mkstemp(name);
+        EXPECT_GE(fd, 0);
+        ::close(fd);
+        path = name;
+    }
+
+    ~temporary_path()
+    {
+        std::remove(path.c_str());
+    }
+
+    std::size_t file_size() const
+    {
+        struct ::stat status;
+        EXPECT_EQ(::stat(path.c_str(), &status), 0);
+        return std::size_t(status.st_size);
+    }
+
+    // The size of the disk blocks that the file was given.
+    std::size_t allocated_size() const
+    {
+        struct ::stat status;
+        EXPECT_EQ(::stat(path.c_str(), &status), 0);
+        return std::size_t(status.st_blocks) * 512;
+    }
+
+    std::string path;
+};
+
+TEST(test_mapped_output_file, output_matches_vector_output)
+{
+    auto items = records();
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(items).or_throw();
+
+    temporary_path path;
+    {
+        zpp::bits::mapped_output_file file;
+        file.open(path.path.c_str()).or_throw();
+
+        zpp::bits::out out{file};
+        out(items).or_throw();
+        EXPECT_EQ(file.size(), out.position());
+        file.sync().or_throw();
+    }
+    ASSERT_EQ(path.file_size(), expected.size());
+
+    zpp::bits::mapped_file mapping;
+    mapping.open(path.path.c_str()).or_throw();
+    EXPECT_TRUE(std::equal(mapping.begin(),
+                           mapping.end(),
+                           expected.begin(),
+                           expected.end()));
+
+    std::vector<record> restored;
+    zpp::bits::in{mapping}(restored).or_throw();
+    ASSERT_EQ(restored.size(), items.size());
+    EXPECT_EQ(restored.back().name, items.back().name);
+    EXPECT_EQ(restored.back().payload, items.back().payload);
+}
+
+TEST(test_mapped_output_file, no_fit_size_leaves_room)
+{
+    temporary_path path;
+    zpp::bits::mapped_output_file file;
+    file.open(path.path.c_str()).or_throw();
+
+    zpp::bits::out out{file, zpp::bits::no_fit_size{}, zpp::bits::enlarger<2>{}};
+    out(records()).or_throw();
+    EXPECT_GT(file.size(), out.position());
+    EXPECT_EQ(path.file_size(), file.size());
+
+    file.resize(out.position()).or_throw();
+    EXPECT_EQ(path.file_size(), out.position());
+}
+
+TEST(test_mapped_output_file, exact_enlarger)
+{
+    temporary_path path;
+    zpp::bits::mapped_output_file file;
+    file.open(path.path.c_str()).or_throw();
+
+    zpp::bits::out out{file, zpp::bits::exact_enlarger{}};
+    out(std::uint32_t{1}, std::uint64_t{2}).or_throw();
+    EXPECT_EQ(file.size(), sizeof(std::uint32_t) + sizeof(std::uint64_t));
+    EXPECT_EQ(path.file_size(), file.size());
+}
+
+TEST(test_mapped_output_file, growth_reserves_disk_blocks)
+{
+    temporary_path path;
+    zpp::bits::mapped_output_file file;
+    file.open(path.path.c_str()).or_throw();
+
+    // A sparse file would only find out that the disk is full when the
+    // mapping is written to.
+    constexpr std::size_t size = 0x100000;
+    file.resize(size).or_throw();
+    EXPECT_EQ(path.file_size(), size);
+    EXPECT_GE(path.allocated_size(), size);
+}
+
+TEST(test_mapped_output_file, alloc_limit)
+{
+    temporary_path path;
+    zpp::bits::mapped_output_file file;
+    file.open(path.path.c_str()).or_throw();
+
+    zpp::bits::out out{file, zpp::bits::alloc_limit<0x100>{}};
+    EXPECT_EQ(out(records()), std::errc::no_buffer_space);
+}
+
+TEST(test_mapped_output_file, not_open)
+{
+    zpp::bits::mapped_output_file file;
+    EXPECT_EQ(zpp::bits::out{file}(std::uint32_t{1}),
+              std::errc::bad_file_descriptor);
+}
+
+} // namespace test_mapped_output_file
+#endif
@@ -0,0 +1,142 @@
+#include "test.h"
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+namespace test_max_serialized_size
+{
+
+struct point
+{
+    std::int32_t x{};
+    std::int32_t y{};
+};
+
+struct sample
+{
+    std::uint8_t kind{};
+    zpp::bits::vint64_t offset{};
+    std::optional<point> position;
+    std::variant<std::monostate, std::int16_t, point> value;
+    std::bitset<10> flags;
+    std::array<zpp::bits::vuint32_t, 3> counters{};
+
+    using serialize = zpp::bits::members<6>;
+};
+
+struct named
+{
+    std::string name;
+    point position;
+};
+
+struct custom
+{
+    std::int32_t value{};
+
+    constexpr static auto serialize(auto & archive, auto & self)
+    {
+        return archive(self.value);
+    }
+};
+
+static_assert(zpp::bits::max_serialized_size_v<std::int32_t> == 4);
+static_assert(zpp::bits::max_serialized_size_v<point> == sizeof(point));
+static_assert(zpp::bits::max_serialized_size_v<zpp::bits::vint32_t> == 5);
+static_assert(zpp::bits::max_serialized_size_v<zpp::bits::vuint64_t> == 10);
+static_assert(zpp::bits::max_serialized_size_v<std::bitset<10>> == 2);
+static_assert(zpp::bits::max_serialized_size_v<std::optional<point>> ==
+              1 + sizeof(point));
+static_assert(zpp::bits::max_serialized_size_v<
+                  std::variant<std::monostate, std::int16_t, point>> ==
+              1 + sizeof(point));
+static_assert(zpp::bits::max_serialized_size_v<std::tuple<char, point>> ==
+              1 + sizeof(point));
+static_assert(zpp::bits::max_serialized_size_v<point[3]> ==
+              3 * sizeof(point));
+static_assert(zpp::bits::max_serialized_size_v<sample> ==
+              1 + 10 + (1 + 8) + (1 + 8) + 2 + 3 * 5);
+
+static_assert(!zpp::bits::concepts::bounded_serialized_size<std::string>);
+static_assert(
+    !zpp::bits::concepts::bounded_serialized_size<std::vector<point>>);
+static_assert(!zpp::bits::concepts::bounded_serialized_size<named>);
+static_assert(!zpp::bits::concepts::bounded_serialized_size<custom>);
+static_assert(!zpp::bits::concepts::bounded_serialized_size<
+              std::variant<point, std::string>>);
+
+static sample some_sample()
+{
+    return {7, -1, point{1, 2}, point{3, 4}, 0b1010000001, {1, 300, 70000}};
+}
+
+TEST(test_max_serialized_size, bounded_output_matches)
+{
+    auto value = some_sample();
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(value).or_throw();
+
+    std::array<std::byte, zpp::bits::max_serialized_size_v<sample>> data{};
+    zpp::bits::out out{data};
+    out(value).or_throw();
+
+    ASSERT_LE(expected.size(), data.size());
+    EXPECT_EQ(out.position(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), data.begin()));
+
+    sample restored;
+    zpp::bits::in{std::span{data}.first(out.position())}(restored).or_throw();
+    EXPECT_EQ(restored.offset, -1);
+    EXPECT_EQ(restored.position->y, 2);
+    EXPECT_EQ(std::get<point>(restored.value).x, 3);
+    EXPECT_EQ(restored.flags, value.flags);
+    EXPECT_EQ(restored.counters[2], 70000u);
+}
+
+TEST(test_max_serialized_size, too_little_room_is_still_checked)
+{
+    auto value = some_sample();
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(value).or_throw();
+
+    // Less room than the maximum, yet enough for this particular value.
+    std::array<std::byte, 45> enough{};
+    static_assert(45 < zpp::bits::max_serialized_size_v<sample>);
+    ASSERT_LE(expected.size(), enough.size());
+    zpp::bits::out out{enough};
+    out(value).or_throw();
+    EXPECT_EQ(out.position(), expected.size());
+
+    std::array<std::byte, 20> little{};
+    EXPECT_EQ(zpp::bits::out{little}(value), std::errc::result_out_of_range);
+}
+
+TEST(test_max_serialized_size, several_items)
+{
+    std::array<std::byte, 64> data{};
+    zpp::bits::out out{data, zpp::bits::endian::big{}};
+    out(std::uint16_t{0x1234}, point{1, 2}).or_throw();
+    out(zpp::bits::vuint32_t{300}).or_throw();
+
+    EXPECT_EQ(out.position(), 2u + sizeof(point) + 2u);
+    EXPECT_EQ(data[0], std::byte{0x12});
+    EXPECT_EQ(data[1], std::byte{0x34});
+    EXPECT_EQ(data[5], std::byte{1});
+}
+
+TEST(test_max_serialized_size, to_bytes)
+{
+    constexpr auto data = zpp::bits::to_bytes<point{1, 2}, std::uint8_t{3}>();
+    static_assert(data.size() == sizeof(point) + 1);
+    static_assert(zpp::bits::from_bytes<data, point>().y == 2);
+}
+
+} // namespace test_max_serialized_size
@@ -0,0 +1,237 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace test_memory_resource
+{
+
+// Fails every allocation that falls back to the default resource while it
+// is in scope.
+struct no_default_resource
+{
+    no_default_resource() :
+        previous(std::pmr::set_default_resource(
+            std::pmr::null_memory_resource()))
+    {
+    }
+
+    ~no_default_resource()
+    {
+        std::pmr::set_default_resource(previous);
+    }
+
+    std::pmr::memory_resource * previous;
+};
+
+struct point
+{
+    std::int32_t x{};
+    std::int32_t y{};
+};
+
+struct message
+{
+    using serialize = zpp::bits::members<5>;
+
+    std::pmr::string name;
+    std::pmr::vector<std::pmr::string> tags;
+    std::pmr::map<std::pmr::string, std::pmr::vector<std::int32_t>> values;
+    std::optional<std::pmr::string> note;
+    std::shared_ptr<point> origin;
+};
+
+static std::vector<std::byte> some_message()
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(
+        std::string(100, 'n'),
+        std::vector<std::string>{std::string(50, 'a'), std::string(60, 'b')},
+        std::map<std::string, std::vector<std::int32_t>>{
+            {std::string(40, 'k'), {1, 2, 3}}, {std::string(45, 'l'), {4}}},
+        std::optional<std::string>{std::string(70, 'o')},
+        std::make_shared<point>(point{1, 2}))
+        .or_throw();
+    return data;
+}
+
+TEST(test_memory_resource, message_from_arena)
+{
+    auto data = some_message();
+
+    counting_resource upstream;
+    std::pmr::monotonic_buffer_resource arena{&upstream};
+    message restored;
+    {
+        no_default_resource guard;
+        zpp::bits::in{data, zpp::bits::memory_resource{&arena}}(restored)
+            .or_throw();
+    }
+
+    EXPECT_GT(upstream.allocations, 0u);
+    EXPECT_EQ(restored.name, std::pmr::string(100, 'n'));
+    EXPECT_EQ(restored.name.get_allocator().resource(), &arena);
+    ASSERT_EQ(restored.tags.size(), 2u);
+    EXPECT_EQ(restored.tags[1], std::pmr::string(60, 'b'));
+    EXPECT_EQ(restored.tags[1].get_allocator().resource(), &arena);
+    ASSERT_EQ(restored.values.size(), 2u);
+    EXPECT_EQ(restored.values.begin()->first, std::pmr::string(40, 'k'));
+    EXPECT_EQ(restored.values.begin()->first.get_allocator().resource(),
+              &arena);
+    EXPECT_EQ(restored.values.rbegin()->second,
+              std::pmr::vector<std::int32_t>{4});
+    EXPECT_EQ(restored.note->get_allocator().resource(), &arena);
+    EXPECT_EQ(restored.origin->y, 2);
+}
+
+TEST(test_memory_resource, shared_pointer)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::make_shared<point>(point{1, 2})).or_throw();
+
+    counting_resource resource;
+    std::shared_ptr<point> origin;
+    zpp::bits::in{data, zpp::bits::memory_resource{&resource}}(origin)
+        .or_throw();
+    EXPECT_EQ(resource.allocations, 1u);
+    EXPECT_EQ(origin->x, 1);
+    EXPECT_EQ(origin->y, 2);
+}
+
+TEST(test_memory_resource, previous_contents_are_replaced)
+{
+    auto data = some_message();
+
+    std::pmr::monotonic_buffer_resource arena;
+    message restored;
+    restored.name.assign(200, 'p');
+    restored.tags.emplace_back(200, 't');
+    zpp::bits::in{data, zpp::bits::memory_resource{&arena}}(restored)
+        .or_throw();
+
+    EXPECT_EQ(restored.name, std::pmr::string(100, 'n'));
+    EXPECT_EQ(restored.name.get_allocator().resource(), &arena);
+    EXPECT_EQ(restored.tags.size(), 2u);
+    EXPECT_EQ(restored.tags.get_allocator().resource(), &arena);
+}
+
+TEST(test_memory_resource, map_elements_use_its_allocator)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(
+        std::map<std::string, std::string>{
+            {std::string(40, 'k'), std::string(50, 'v')}},
+        std::set<std::string>{std::string(40, 's')})
+        .or_throw();
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::map<std::pmr::string, std::pmr::string> map{&arena};
+    std::pmr::set<std::pmr::string> set{&arena};
+    {
+        // Without the option, only the allocator that each container was
+        // given is used.
+        no_default_resource guard;
+        zpp::bits::in{data}(map, set).or_throw();
+    }
+
+    EXPECT_EQ(map.begin()->second, std::pmr::string(50, 'v'));
+    EXPECT_EQ(map.begin()->second.get_allocator().resource(), &arena);
+    EXPECT_EQ(*set.begin(), std::pmr::string(40, 's'));
+}
+
+// Orders either way, as chosen at runtime.
+struct either_way
+{
+    bool operator()(int left, int right) const
+    {
+        return descending ? right < left : left < right;
+    }
+
+    bool descending = false;
+};
+
+// Hashes with a seed chosen at runtime.
+struct seeded_hash
+{
+    std::size_t operator()(int value) const
+    {
+        return std::hash<int>{}(value) ^ seed;
+    }
+
+    std::size_t seed = 0;
+};
+
+TEST(test_memory_resource, containers_keep_comparator_and_hasher)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::set<int>{1, 2, 3}, std::unordered_set<int>{4})
+        .or_throw();
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::set<int, either_way, std::pmr::polymorphic_allocator<int>> set{
+        either_way{true}};
+    std::unordered_set<int,
+                       seeded_hash,
+                       std::equal_to<int>,
+                       std::pmr::polymorphic_allocator<int>>
+        hashed{0, seeded_hash{0x1234}};
+    zpp::bits::in{data, zpp::bits::memory_resource{&arena}}(set, hashed)
+        .or_throw();
+
+    EXPECT_EQ(set.get_allocator().resource(), &arena);
+    EXPECT_TRUE(set.key_comp().descending);
+    EXPECT_EQ(*set.begin(), 3);
+    EXPECT_EQ(hashed.get_allocator().resource(), &arena);
+    EXPECT_EQ(hashed.hash_function().seed, 0x1234u);
+    EXPECT_TRUE(hashed.contains(4));
+}
+
+struct pb_inner
+{
+    std::pmr::string name;
+    std::pmr::vector<std::int32_t> values;
+};
+
+auto serialize(const pb_inner &) -> zpp::bits::pb_protocol;
+
+struct pb_outer
+{
+    zpp::bits::vint32_t id;
+    pb_inner inner;
+};
+
+auto serialize(const pb_outer &) -> zpp::bits::pb_protocol;
+
+TEST(test_memory_resource, pb_nested_message)
+{
+    std::vector<std::byte> data;
+    pb_outer message;
+    message.id = 1;
+    message.inner.name.assign(100, 'n');
+    message.inner.values.assign({1, 2, 3});
+    zpp::bits::out{data}(message).or_throw();
+
+    std::pmr::monotonic_buffer_resource arena;
+    pb_outer restored;
+    {
+        no_default_resource guard;
+        zpp::bits::in{data, zpp::bits::memory_resource{&arena}}(restored)
+            .or_throw();
+    }
+
+    EXPECT_EQ(restored.id, 1);
+    EXPECT_EQ(restored.inner.name, std::pmr::string(100, 'n'));
+    EXPECT_EQ(restored.inner.name.get_allocator().resource(), &arena);
+    EXPECT_EQ(restored.inner.values, (std::pmr::vector<std::int32_t>{1, 2, 3}));
+    EXPECT_EQ(restored.inner.values.get_allocator().resource(), &arena);
+}
+
+} // namespace test_memory_resource
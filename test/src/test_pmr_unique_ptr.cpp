@@ -0,0 +1,138 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+namespace test_pmr_unique_ptr
+{
+
+template <template <typename> typename Deleter>
+struct tree
+{
+    using serialize = zpp::bits::members<3>;
+
+    std::int32_t value{};
+    zpp::bits::optional_ptr<tree, Deleter<tree>> left;
+    zpp::bits::optional_ptr<tree, Deleter<tree>> right;
+};
+
+// A complete tree with values in breadth first order.
+template <typename Tree>
+static void grow(Tree & node, std::int32_t value, std::int32_t count)
+{
+    node.value = value;
+    if (2 * value + 1 < count) {
+        node.left.reset(new Tree{});
+        grow(*node.left, 2 * value + 1, count);
+    }
+    if (2 * value + 2 < count) {
+        node.right.reset(new Tree{});
+        grow(*node.right, 2 * value + 2, count);
+    }
+}
+
+template <typename Tree>
+static std::int32_t sum(const Tree & node)
+{
+    return node.value + (node.left ? sum(*node.left) : 0) +
+           (node.right ? sum(*node.right) : 0);
+}
+
+TEST(test_pmr_unique_ptr, tree_from_pool)
+{
+    constexpr std::int32_t count = 10000;
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    {
+        tree<std::default_delete> source;
+        grow(source, 0, count);
+        out(source).or_throw();
+    }
+
+    counting_resource upstream;
+    std::pmr::unsynchronized_pool_resource pool{&upstream};
+    {
+        tree<zpp::bits::pmr_delete> restored;
+        zpp::bits::in in{data, zpp::bits::memory_resource{&pool}};
+        in(restored).or_throw();
+
+        EXPECT_EQ(sum(restored), count * (count - 1) / 2);
+        EXPECT_EQ(restored.left.get_deleter().resource, &pool);
+        EXPECT_EQ(restored.right->right.get_deleter().resource, &pool);
+        EXPECT_LT(upstream.allocations, std::size_t{count} / 100);
+    }
+}
+
+TEST(test_pmr_unique_ptr, resource_of_the_pointer)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::make_unique<std::vector<int>>(std::vector{1, 2, 3})).or_throw();
+
+    counting_resource resource;
+    zpp::bits::pmr_unique_ptr<std::vector<int>> pointer{
+        nullptr, zpp::bits::pmr_delete<std::vector<int>>{&resource}};
+    in(pointer).or_throw();
+
+    EXPECT_EQ(*pointer, (std::vector{1, 2, 3}));
+    EXPECT_EQ(pointer.get_deleter().resource, &resource);
+    EXPECT_EQ(resource.allocations, 1u);
+}
+
+TEST(test_pmr_unique_ptr, optional)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(zpp::bits::optional_ptr{std::make_unique<int>(0x1337)},
+        zpp::bits::optional_ptr<int>{})
+        .or_throw();
+
+    EXPECT_EQ(encode_hex(data),
+              "01"
+              "37130000"
+              "00");
+
+    std::pmr::monotonic_buffer_resource arena;
+    zpp::bits::optional_ptr<int, zpp::bits::pmr_delete<int>> present;
+    zpp::bits::optional_ptr<int, zpp::bits::pmr_delete<int>> absent{
+        zpp::bits::pmr_unique_ptr<int>{
+            new (arena.allocate(sizeof(int), alignof(int))) int{1},
+            zpp::bits::pmr_delete<int>{&arena}}};
+    zpp::bits::in{data, zpp::bits::memory_resource{&arena}}(present, absent)
+        .or_throw();
+
+    EXPECT_EQ(*present, 0x1337);
+    EXPECT_EQ(present.get_deleter().resource, &arena);
+    EXPECT_EQ(absent, nullptr);
+}
+
+struct throws_on_construction
+{
+    using serialize = zpp::bits::members<1>;
+
+    throws_on_construction()
+    {
+        throw std::runtime_error("throws_on_construction");
+    }
+
+    std::int32_t value{};
+};
+
+TEST(test_pmr_unique_ptr, construction_throws)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::int32_t{1}).or_throw();
+
+    counting_resource resource;
+    zpp::bits::pmr_unique_ptr<throws_on_construction> pointer{
+        nullptr,
+        zpp::bits::pmr_delete<throws_on_construction>{&resource}};
+    EXPECT_THROW(in(pointer).or_throw(), std::runtime_error);
+
+    EXPECT_EQ(pointer, nullptr);
+    EXPECT_EQ(resource.allocations, 1u);
+    EXPECT_EQ(resource.deallocations, 1u);
+}
+
+} // namespace test_pmr_unique_ptr
@@ -0,0 +1,369 @@
+#include "test.h"
+
+namespace test_rpc_batch
+{
+
+using namespace std::literals;
+using namespace zpp::bits::literals;
+
+int add(int left, int right)
+{
+    return left + right;
+}
+
+zpp::bits::errc refuse()
+{
+    return std::errc::permission_denied;
+}
+
+std::string greet(std::string name)
+{
+    return "hello " + name;
+}
+
+double scale(std::uint8_t factor, double value)
+{
+    return factor * value;
+}
+
+struct counter
+{
+    void increment(int by)
+    {
+        value += by;
+    }
+
+    int get()
+    {
+        return value;
+    }
+
+    int value = 0;
+};
+
+using rpc = zpp::bits::rpc<
+    zpp::bits::bind<add, "add"_sha256_int>,
+    zpp::bits::bind<refuse, "refuse"_sha256_int>,
+    zpp::bits::bind<greet, "greet"_sha256_int>,
+    zpp::bits::bind<scale, "scale"_sha256_int>,
+    zpp::bits::bind<&counter::increment, "counter::increment"_sha256_int>,
+    zpp::bits::bind<&counter::get, "counter::get"_sha256_int>>;
+
+TEST(test_rpc_batch, serve_all)
+{
+    std::vector<std::byte> requests;
+    std::vector<std::byte> responses;
+    zpp::bits::in in_requests{requests};
+    zpp::bits::out out_requests{requests};
+    zpp::bits::in in_responses{responses};
+    zpp::bits::out out_responses{responses};
+
+    counter context;
+    rpc::client client{in_responses, out_requests};
+    rpc::server server{in_requests, out_responses, context};
+
+    for (int i = 0; i < 1000; ++i) {
+        client.batch_request<"add"_sha256_int>(i, 1).or_throw();
+    }
+    client.batch_request<"greet"_sha256_int>("world"s).or_throw();
+    client.batch_request<"counter::increment"_sha256_int>(5).or_throw();
+    client.batch_request<"counter::increment"_sha256_int>(7).or_throw();
+    client.batch_request<"counter::get"_sha256_int>().or_throw();
+
+    server.serve_all().or_throw();
+    EXPECT_EQ(in_requests.remaining_data().size(), 0u);
+    EXPECT_EQ(context.value, 12);
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(),
+                  i + 1);
+    }
+    EXPECT_EQ(client.batch_response<"greet"_sha256_int>().or_throw(),
+              "hello world");
+    client.batch_response<"counter::increment"_sha256_int>().or_throw();
+    client.batch_response<"counter::increment"_sha256_int>().or_throw();
+    EXPECT_EQ(client.batch_response<"counter::get"_sha256_int>().or_throw(),
+              12);
+    EXPECT_EQ(in_responses.remaining_data().size(), 0u);
+}
+
+TEST(test_rpc_batch, errors_do_not_abort)
+{
+    std::vector<std::byte> requests;
+    std::vector<std::byte> responses;
+    zpp::bits::in in_requests{requests};
+    zpp::bits::out out_requests{requests};
+    zpp::bits::in in_responses{responses};
+    zpp::bits::out out_responses{responses};
+
+    counter context;
+    rpc::client client{in_responses, out_requests};
+    rpc::server server{in_requests, out_responses, context};
+
+    client.batch_request<"add"_sha256_int>(1, 2).or_throw();
+    client.batch_request<"refuse"_sha256_int>().or_throw();
+
+    // A request of an unknown id, framed like any other.
+    out_requests(std::uint32_t{sizeof("nothing"_sha256_int) + sizeof(int)},
+                 "nothing"_sha256_int,
+                 1)
+        .or_throw();
+
+    // A request of a string longer than the whole batch.
+    out_requests(std::uint32_t{sizeof("greet"_sha256_int) + 4},
+                 "greet"_sha256_int,
+                 std::uint32_t{0xffffffff})
+        .or_throw();
+
+    client.batch_request<"add"_sha256_int>(9, 3).or_throw();
+
+    server.serve_all().or_throw();
+
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(), 3);
+    EXPECT_EQ(client.batch_response<"refuse"_sha256_int>(),
+              std::errc::permission_denied);
+    EXPECT_EQ(client.batch_response<"refuse"_sha256_int>(),
+              std::errc::not_supported);
+    EXPECT_EQ(client.batch_response<"greet"_sha256_int>().error(),
+              std::errc::result_out_of_range);
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(), 12);
+    EXPECT_EQ(in_responses.remaining_data().size(), 0u);
+}
+
+TEST(test_rpc_batch, malformed_frames)
+{
+    std::vector<std::byte> requests;
+    std::vector<std::byte> responses;
+    zpp::bits::in in_requests{requests};
+    zpp::bits::out out_requests{requests};
+    zpp::bits::in in_responses{responses};
+    zpp::bits::out out_responses{responses};
+
+    counter context;
+    rpc::client client{in_responses, out_requests};
+    rpc::server server{in_requests, out_responses, context};
+
+    client.batch_request<"add"_sha256_int>(1, 2).or_throw();
+
+    // Arguments that are longer than the binding reads.
+    out_requests(std::uint32_t{sizeof("add"_sha256_int) + 3 * sizeof(int)},
+                 "add"_sha256_int,
+                 1,
+                 2,
+                 3)
+        .or_throw();
+
+    // Arguments that are shorter than the binding reads, followed by a
+    // request that must not be read in their place.
+    out_requests(std::uint32_t{sizeof("add"_sha256_int) + sizeof(int)},
+                 "add"_sha256_int,
+                 4)
+        .or_throw();
+    client.batch_request<"add"_sha256_int>(9, 3).or_throw();
+
+    // The last response is rewound as well.
+    out_requests(std::uint32_t{sizeof("add"_sha256_int) + 3 * sizeof(int)},
+                 "add"_sha256_int,
+                 5,
+                 6,
+                 7)
+        .or_throw();
+
+    server.serve_all().or_throw();
+
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(), 3);
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().error(),
+              std::errc::message_size);
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().error(),
+              std::errc::result_out_of_range);
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(), 12);
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().error(),
+              std::errc::message_size);
+    EXPECT_EQ(in_responses.remaining_data().size(), 0u);
+}
+
+TEST(test_rpc_batch, truncated_frame)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    counter context;
+    auto [client, server] = rpc::client_server(in, out, context);
+
+    client.batch_request<"add"_sha256_int>(1, 2).or_throw();
+    data.resize(data.size() - 1);
+
+    EXPECT_EQ(server.serve_all(), std::errc::result_out_of_range);
+}
+
+TEST(test_rpc_batch, second_of_three_fails)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    counter context;
+    auto [client, server] = rpc::client_server(in, out, context);
+
+    client.batch_request<"add"_sha256_int>(1, 2).or_throw();
+    client.batch_request<"refuse"_sha256_int>().or_throw();
+    client.batch_request<"add"_sha256_int>(3, 4).or_throw();
+
+    server.serve_all().or_throw();
+
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(), 3);
+    EXPECT_EQ(client.batch_response<"refuse"_sha256_int>(),
+              std::errc::permission_denied);
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(), 7);
+    EXPECT_EQ(in.remaining_data().size(), 0u);
+}
+
+TEST(test_rpc_batch, stopped_batch_keeps_earlier_responses)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    counter context;
+    auto [client, server] = rpc::client_server(in, out, context);
+
+    client.batch_request<"add"_sha256_int>(1, 2).or_throw();
+    client.batch_request<"refuse"_sha256_int>().or_throw();
+
+    // A frame that claims more than the rest of the batch.
+    out(std::uint32_t{0x100}, "add"_sha256_int, 3, 4).or_throw();
+
+    auto responses = out.position();
+    EXPECT_EQ(server.serve_all(), std::errc::result_out_of_range);
+
+    in.position() = responses;
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(), 3);
+    EXPECT_EQ(client.batch_response<"refuse"_sha256_int>(),
+              std::errc::permission_denied);
+    EXPECT_EQ(client.batch_response<"add"_sha256_int>().error(),
+              std::errc::result_out_of_range);
+}
+
+TEST(test_rpc_batch, shared_storage)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    counter context;
+    auto [client, server] = rpc::client_server(in, out, context);
+
+    // Responses that are larger than their requests, so that the storage
+    // is moved while the requests after them are read.
+    for (int i = 0; i < 100; ++i) {
+        client.batch_request<"greet"_sha256_int>(std::string(i, 'a'))
+            .or_throw();
+    }
+    data.shrink_to_fit();
+
+    server.serve_all().or_throw();
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(client.batch_response<"greet"_sha256_int>().or_throw(),
+                  "hello " + std::string(i, 'a'));
+    }
+    EXPECT_EQ(in.remaining_data().size(), 0u);
+}
+
+TEST(test_rpc_batch, source)
+{
+    std::vector<std::byte> requests;
+    zpp::bits::out out_requests{requests};
+    std::vector<std::byte> responses;
+    zpp::bits::in in_responses{responses};
+    rpc::client client{in_responses, out_requests};
+
+    for (int i = 0; i < 100; ++i) {
+        client.batch_request<"add"_sha256_int>(i, 1).or_throw();
+    }
+    client.batch_request<"greet"_sha256_int>(std::string(100, 'a'))
+        .or_throw();
+    client.batch_request<"refuse"_sha256_int>().or_throw();
+
+    // The window starts out empty, is smaller than some of the requests,
+    // and is refilled in the middle of the frames.
+    zpp::bits::source_buffer source{chunked{requests}, 16};
+    zpp::bits::in in_requests{source};
+    zpp::bits::out out_responses{responses};
+    counter context;
+    rpc::server server{in_requests, out_responses, context};
+    server.serve_all().or_throw();
+    EXPECT_EQ(source.source().position, requests.size());
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(),
+                  i + 1);
+    }
+    EXPECT_EQ(client.batch_response<"greet"_sha256_int>().or_throw(),
+              "hello " + std::string(100, 'a'));
+    EXPECT_EQ(client.batch_response<"refuse"_sha256_int>(),
+              std::errc::permission_denied);
+    EXPECT_EQ(in_responses.remaining_data().size(), 0u);
+}
+
+TEST(test_rpc_batch, truncated_source)
+{
+    std::vector<std::byte> requests;
+    zpp::bits::out out_requests{requests};
+    std::vector<std::byte> responses;
+    zpp::bits::in in_responses{responses};
+    rpc::client client{in_responses, out_requests};
+
+    client.batch_request<"add"_sha256_int>(1, 2).or_throw();
+    client.batch_request<"add"_sha256_int>(3, 4).or_throw();
+
+    // Cut short in the middle of the second frame, and then in the middle
+    // of its size.
+    for (auto cut : {std::size_t{1}, requests.size() / 2 - 2}) {
+        std::vector<std::byte> truncated(requests.begin(),
+                                         requests.end() - cut);
+        zpp::bits::source_buffer source{chunked{truncated}, 16};
+        zpp::bits::in in_requests{source};
+        std::vector<std::byte> served;
+        zpp::bits::out out_responses{served};
+        counter context;
+        rpc::server server{in_requests, out_responses, context};
+        EXPECT_EQ(server.serve_all(), std::errc::result_out_of_range);
+
+        responses = served;
+        in_responses.reset();
+        EXPECT_EQ(client.batch_response<"add"_sha256_int>().or_throw(), 3);
+        EXPECT_EQ(in_responses.remaining_data().size(), 0u);
+    }
+}
+
+TEST(test_rpc_batch, aligned_arguments)
+{
+    auto [data, in, out] = zpp::bits::data_in_out(zpp::bits::aligned<>{});
+    counter context;
+    auto [client, server] = rpc::client_server(in, out, context);
+
+    // The value is padded from the beginning of the input, past the size
+    // and id of the request.
+    client.batch_request<"scale"_sha256_int>(std::uint8_t{2}, 1.5).or_throw();
+    client.batch_request<"scale"_sha256_int>(std::uint8_t{3}, 2.5).or_throw();
+    EXPECT_EQ(data.size(), 2u * (4 + 4 + 8 + 8));
+
+    server.serve_all().or_throw();
+
+    EXPECT_EQ(client.batch_response<"scale"_sha256_int>().or_throw(), 3.0);
+    EXPECT_EQ(client.batch_response<"scale"_sha256_int>().or_throw(), 7.5);
+    EXPECT_EQ(in.remaining_data().size(), 0u);
+}
+
+TEST(test_rpc_batch, frame)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(1, 2, 3).or_throw();
+
+    zpp::bits::in in{data};
+    in.position() = sizeof(int);
+
+    EXPECT_EQ(in.frame(2 * sizeof(int) + 1).error(),
+              std::errc::result_out_of_range);
+
+    auto frame = in.frame(sizeof(int)).or_throw();
+    EXPECT_EQ(frame.position(), sizeof(int));
+
+    int value{};
+    frame(value).or_throw();
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(frame(value), std::errc::result_out_of_range);
+    EXPECT_EQ(in.position(), sizeof(int));
+}
+
+} // namespace test_rpc_batch
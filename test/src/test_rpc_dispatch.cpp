@@ -0,0 +1,113 @@
+#include "test.h"
+
+namespace test_rpc_dispatch
+{
+
+using namespace std::literals;
+using namespace zpp::bits::literals;
+
+template <int Number>
+int add(int i)
+{
+    return i + Number;
+}
+
+std::string greet(std::string name)
+{
+    return "hello " + name;
+}
+
+int sum(std::span<const std::byte> input)
+{
+    int left = 0;
+    int right = 0;
+    zpp::bits::in{input}(left, right).or_throw();
+    return left + right;
+}
+
+struct counter
+{
+    void increment(int by)
+    {
+        value += by;
+    }
+
+    int get()
+    {
+        return value;
+    }
+
+    int value = 0;
+};
+
+using rpc = zpp::bits::rpc<zpp::bits::bind<add<0>, "add0"_sha256_int>,
+                           zpp::bits::bind<add<1>, "add1"_sha256_int>,
+                           zpp::bits::bind<add<2>, "add2"_sha256_int>,
+                           zpp::bits::bind<add<3>, "add3"_sha256_int>,
+                           zpp::bits::bind<add<4>, "add4"_sha256_int>,
+                           zpp::bits::bind<greet, "greet"_sha256_int>,
+                           zpp::bits::bind_opaque<sum, "sum"_sha256_int>,
+                           zpp::bits::bind<&counter::increment,
+                                           "counter::increment"_sha256_int>,
+                           zpp::bits::bind<&counter::get,
+                                           "counter::get"_sha256_int>>;
+
+template <auto Id>
+int add_through(int i)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    counter context;
+    auto [client, server] = rpc::client_server(in, out, context);
+    client.template request<Id>(i).or_throw();
+    server.serve().or_throw();
+    return client.template response<Id>().or_throw();
+}
+
+TEST(test_rpc_dispatch, every_binding)
+{
+    static_assert(
+        rpc::server<zpp::bits::in<std::vector<std::byte>> &,
+                    zpp::bits::out<std::vector<std::byte>> &,
+                    counter &>::dispatches_through_table);
+
+    EXPECT_EQ(add_through<"add0"_sha256_int>(10), 10);
+    EXPECT_EQ(add_through<"add1"_sha256_int>(10), 11);
+    EXPECT_EQ(add_through<"add2"_sha256_int>(10), 12);
+    EXPECT_EQ(add_through<"add3"_sha256_int>(10), 13);
+    EXPECT_EQ(add_through<"add4"_sha256_int>(10), 14);
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    counter context;
+    auto [client, server] = rpc::client_server(in, out, context);
+
+    client.request<"greet"_sha256_int>("world"s).or_throw();
+    server.serve().or_throw();
+    EXPECT_EQ(client.response<"greet"_sha256_int>().or_throw(),
+              "hello world");
+
+    client.request<"sum"_sha256_int>(20, 22).or_throw();
+    server.serve().or_throw();
+    EXPECT_EQ(client.response<"sum"_sha256_int>().or_throw(), 42);
+
+    client.request<"counter::increment"_sha256_int>(5).or_throw();
+    server.serve().or_throw();
+    client.request<"counter::increment"_sha256_int>(7).or_throw();
+    server.serve().or_throw();
+    EXPECT_EQ(context.value, 12);
+
+    client.request<"counter::get"_sha256_int>().or_throw();
+    server.serve().or_throw();
+    EXPECT_EQ(client.response<"counter::get"_sha256_int>().or_throw(), 12);
+}
+
+TEST(test_rpc_dispatch, unknown_id)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    counter context;
+    auto [client, server] = rpc::client_server(in, out, context);
+
+    out("nothing"_sha256_int, 1).or_throw();
+    EXPECT_EQ(server.serve(), std::errc::not_supported);
+}
+
+} // namespace test_rpc_dispatch
@@ -0,0 +1,151 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace test_segmented_buffer
+{
+
+// Splits data into a chain of buffers of the given sizes, repeating the
+// last size.
+static auto split(std::span<const std::byte> data,
+                  std::vector<std::size_t> sizes)
+{
+    std::vector<std::span<const std::byte>> segments;
+    std::size_t index = 0;
+    while (!data.empty()) {
+        auto size = std::min(sizes[std::min(index++, sizes.size() - 1)],
+                             data.size());
+        segments.push_back(data.first(size));
+        data = data.subspan(size);
+    }
+    return segments;
+}
+
+TEST(test_segmented_buffer, values_crossing_a_boundary)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::uint32_t{0x04030201},
+                         std::uint64_t{0x0c0b0a0908070605},
+                         std::string("abc"))
+        .or_throw();
+
+    // Every value, and the size of the string, crosses into the next buffer.
+    auto segments = split(data, {2, 5, 6, 3, 2});
+    zpp::bits::segmented_buffer buffer{segments};
+    zpp::bits::in in{buffer};
+
+    std::uint32_t first{};
+    std::uint64_t second{};
+    std::string third;
+    in(first, second, third).or_throw();
+    EXPECT_EQ(first, 0x04030201u);
+    EXPECT_EQ(second, 0x0c0b0a0908070605u);
+    EXPECT_EQ(third, "abc");
+}
+
+TEST(test_segmented_buffer, reads_with_any_boundaries)
+{
+    std::vector<std::string> names;
+    std::vector<zpp::bits::vint64_t> counts;
+    for (int i = 0; i < 100; ++i) {
+        names.push_back(std::string(i % 23, 'n'));
+        counts.push_back(std::int64_t(i) * i * i * i);
+    }
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(names, counts).or_throw();
+
+    for (std::size_t size : {1, 3, 7, 64, 1000}) {
+        auto segments = split(data, {size});
+        zpp::bits::segmented_buffer buffer{segments};
+        zpp::bits::in in{buffer};
+
+        std::vector<std::string> restored_names;
+        std::vector<zpp::bits::vint64_t> restored_counts;
+        in(restored_names, restored_counts).or_throw();
+        EXPECT_EQ(restored_names, names);
+        EXPECT_EQ(restored_counts, counts);
+    }
+}
+
+TEST(test_segmented_buffer, empty_and_uneven_segments)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::uint32_t{1}, std::string(20, 'x'),
+                         std::uint16_t{2})
+        .or_throw();
+
+    auto segments = split(data, {0, 5, 0, 0, 2, 11, 0, 300});
+    zpp::bits::segmented_buffer buffer{segments};
+    zpp::bits::in in{buffer};
+
+    std::uint32_t first{};
+    std::string second;
+    std::uint16_t third{};
+    in(first, second, third).or_throw();
+    EXPECT_EQ(first, 1u);
+    EXPECT_EQ(second, std::string(20, 'x'));
+    EXPECT_EQ(third, 2u);
+}
+
+TEST(test_segmented_buffer, values_within_a_segment_are_read_in_place)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::uint32_t{1}, std::uint32_t{2}).or_throw();
+
+    auto segments = split(data, {8});
+    zpp::bits::segmented_buffer buffer{segments};
+    zpp::bits::in in{buffer};
+
+    std::uint32_t first{};
+    in(first).or_throw();
+    EXPECT_EQ(first, 1u);
+    EXPECT_EQ(buffer.data(), data.data());
+}
+
+struct pb_record
+{
+    zpp::bits::vint32_t id;
+    std::string name;
+
+    using serialize = zpp::bits::pb_protocol;
+};
+
+TEST(test_segmented_buffer, protobuf_messages)
+{
+    std::vector<pb_record> messages;
+    for (int i = 0; i < 20; ++i) {
+        messages.push_back({i, std::string(i * 7, 'x')});
+    }
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(messages).or_throw();
+
+    auto segments = split(data, {13});
+    zpp::bits::segmented_buffer buffer{segments};
+
+    std::vector<pb_record> restored;
+    zpp::bits::in{buffer}(restored).or_throw();
+    ASSERT_EQ(restored.size(), messages.size());
+    EXPECT_EQ(restored.back().id, messages.back().id);
+    EXPECT_EQ(restored.back().name, messages.back().name);
+}
+
+TEST(test_segmented_buffer, truncated_input_is_rejected)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::string(100, 'x')).or_throw();
+    data.resize(data.size() - 1);
+
+    auto segments = split(data, {9});
+    zpp::bits::segmented_buffer buffer{segments};
+
+    std::string restored;
+    EXPECT_EQ(zpp::bits::in{buffer}(restored),
+              std::errc::result_out_of_range);
+}
+
+} // namespace test_segmented_buffer
@@ -0,0 +1,155 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace test_serialized_size
+{
+
+struct point
+{
+    std::int32_t x{};
+    std::int32_t y{};
+};
+
+struct person
+{
+    std::string name;
+    std::vector<point> points;
+    std::optional<std::int64_t> id;
+    std::variant<std::monostate, std::string, point> extra;
+    std::map<std::string, zpp::bits::vint32_t> tags;
+
+    using serialize = zpp::bits::members<5>;
+};
+
+struct pb_person
+{
+    std::string name;
+    zpp::bits::vint32_t id;
+    std::vector<std::string> emails;
+
+    using serialize = zpp::bits::pb_protocol;
+};
+
+static person someone()
+{
+    return {"someone",
+            {{1, 2}, {3, 4}, {5, 6}},
+            1337,
+            std::string(300, 'x'),
+            {{"a", 1}, {"b", 1 << 20}}};
+}
+
+static std::size_t output_size(auto &&... items)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(items...).or_throw();
+    return data.size();
+}
+
+TEST(test_serialized_size, fixed_size_is_constant)
+{
+    static_assert(zpp::bits::serialized_size(std::int32_t{}, double{}).value() ==
+                  sizeof(std::int32_t) + sizeof(double));
+    static_assert(zpp::bits::serialized_size(point{}).value() == sizeof(point));
+    static_assert(zpp::bits::serialized_size(std::array<point, 3>{}).value() ==
+                  3 * sizeof(point));
+}
+
+TEST(test_serialized_size, constexpr_variable_size)
+{
+    static_assert(zpp::bits::serialized_size(std::string("hello")).value() ==
+                  sizeof(std::uint32_t) + 5);
+    static_assert(zpp::bits::serialized_size<zpp::bits::size_varint>(
+                      std::vector<int>{1, 2, 3})
+                      .value() == 1 + 3 * sizeof(int));
+}
+
+TEST(test_serialized_size, matches_output)
+{
+    auto value = someone();
+    EXPECT_EQ(zpp::bits::serialized_size(value).or_throw(),
+              output_size(value));
+    EXPECT_EQ(zpp::bits::serialized_size(value, value, point{}).or_throw(),
+              output_size(value, value, point{}));
+}
+
+TEST(test_serialized_size, honors_options)
+{
+    auto value = someone();
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data, zpp::bits::size_varint{}}(value).or_throw();
+    EXPECT_EQ(
+        zpp::bits::serialized_size<zpp::bits::size_varint>(value).or_throw(),
+        data.size());
+
+    data.clear();
+    zpp::bits::out{data, zpp::bits::endian::swapped{}}(point{1, 2})
+        .or_throw();
+    EXPECT_EQ(zpp::bits::serialized_size<zpp::bits::endian::swapped>(
+                  point{1, 2})
+                  .or_throw(),
+              data.size());
+}
+
+TEST(test_serialized_size, protobuf)
+{
+    pb_person value{"name", 150, {"a@b.c", std::string(200, 'd')}};
+    EXPECT_EQ(zpp::bits::serialized_size(value).or_throw(),
+              output_size(value));
+    EXPECT_EQ(zpp::bits::serialized_size(zpp::bits::unsized(value))
+                  .or_throw(),
+              output_size(zpp::bits::unsized(value)));
+}
+
+TEST(test_serialized_size, counts_without_keeping_bytes)
+{
+    std::vector<pb_person> values(
+        3, pb_person{"name", 150, {std::string(0x10000, 'd')}});
+    std::vector<std::byte> payload(0x10000);
+
+    zpp::bits::counting_buffer buffer;
+    zpp::bits::out out{buffer, zpp::bits::size_varint{}};
+    out(values, payload, someone()).or_throw();
+
+    EXPECT_EQ(buffer.flushed(),
+              zpp::bits::serialized_size<zpp::bits::size_varint>(
+                  values, payload, someone())
+                  .or_throw());
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data, zpp::bits::size_varint{}}(values, payload, someone())
+        .or_throw();
+    EXPECT_EQ(buffer.flushed(), data.size());
+    EXPECT_EQ(buffer.size(), 0x100u);
+}
+
+TEST(test_serialized_size, errors_are_reported)
+{
+    std::unique_ptr<int> empty;
+    EXPECT_EQ(zpp::bits::serialized_size(empty).error(),
+              std::errc::invalid_argument);
+}
+
+TEST(test_serialized_size, reserve_allocates_once)
+{
+    auto value = someone();
+    auto size = zpp::bits::serialized_size(value).or_throw();
+
+    std::vector<std::byte> data;
+    zpp::bits::out out{data, zpp::bits::reserve(size)};
+    auto allocation = data.data();
+    out(value).or_throw();
+
+    EXPECT_EQ(data.data(), allocation);
+    EXPECT_EQ(data.size(), size);
+    EXPECT_EQ(data.capacity(), size);
+}
+
+} // namespace test_serialized_size
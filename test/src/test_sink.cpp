@@ -0,0 +1,227 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace test_sink
+{
+
+TEST(test_sink, output_matches_vector_output)
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < 100; ++i) {
+        names.push_back(std::string(i, 'a'));
+    }
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(names).or_throw();
+
+    zpp::bits::sink_buffer buffer{collect{}, 64};
+    zpp::bits::out out{buffer};
+    out(names).or_throw();
+
+    EXPECT_EQ(join_segments(buffer.sink().writes), expected);
+    EXPECT_EQ(buffer.flushed(), expected.size());
+    EXPECT_EQ(buffer.size(), 64u);
+    EXPECT_EQ(out.position(), 0u);
+}
+
+TEST(test_sink, flushes_when_full)
+{
+    zpp::bits::sink_buffer buffer{collect{}, 8};
+    zpp::bits::out out{buffer};
+    out(std::string("ab"), std::string("cd"), std::string("ef")).or_throw();
+
+    // Each string takes six bytes, so the next one does not fit the two
+    // bytes that are left, and the buffer is flushed short before it.
+    EXPECT_EQ(buffer.sink().sizes(), (std::vector<std::size_t>{6, 6, 6}));
+    EXPECT_EQ(encode_hex(join_segments(buffer.sink().writes)),
+              "020000006162"
+              "020000006364"
+              "020000006566");
+    EXPECT_EQ(buffer.size(), 8u);
+}
+
+TEST(test_sink, fixed_size_run_grows_the_buffer)
+{
+    zpp::bits::sink_buffer buffer{collect{}, 8};
+    zpp::bits::out out{buffer};
+    out(std::uint32_t{1}, std::uint32_t{2}, std::uint32_t{3}).or_throw();
+
+    // A run of fixed size values is written as a whole, so the buffer grows
+    // to hold it rather than flushing in its middle.
+    EXPECT_EQ(buffer.sink().sizes(), (std::vector<std::size_t>{12}));
+    EXPECT_GE(buffer.size(), 12u);
+    EXPECT_EQ(encode_hex(join_segments(buffer.sink().writes)),
+              "010000000200000003000000");
+}
+
+TEST(test_sink, every_call_is_flushed)
+{
+    zpp::bits::sink_buffer buffer{collect{}};
+    zpp::bits::out out{buffer};
+
+    out(std::int32_t{1}).or_throw();
+    EXPECT_EQ(buffer.sink().writes.size(), 1u);
+
+    out(std::string("hello")).or_throw();
+    EXPECT_EQ(buffer.sink().writes.size(), 2u);
+    EXPECT_EQ(buffer.flushed(), sizeof(std::int32_t) + sizeof(std::uint32_t) + 5);
+}
+
+TEST(test_sink, payload_that_fits_is_staged)
+{
+    std::vector<std::byte> payload(12, std::byte{0x5a});
+
+    zpp::bits::sink_buffer buffer{collect{}, 16};
+    zpp::bits::out out{buffer};
+    out(std::uint8_t{1}, payload).or_throw();
+
+    // The byte and the size, then the payload staged at the beginning of
+    // the buffer.
+    EXPECT_EQ(buffer.sink().sizes(), (std::vector<std::size_t>{5, 12}));
+    EXPECT_EQ(buffer.sink().writes.back(), payload);
+}
+
+TEST(test_sink, large_payload_is_written_through)
+{
+    std::vector<std::byte> payload(1000, std::byte{0x5a});
+
+    zpp::bits::sink_buffer buffer{collect{}, 16};
+    zpp::bits::out out{buffer};
+    out(std::uint8_t{1}, payload).or_throw();
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(std::uint8_t{1}, payload).or_throw();
+
+    EXPECT_EQ(join_segments(buffer.sink().writes), expected);
+    EXPECT_EQ(buffer.sink().sizes(), (std::vector<std::size_t>{5, 1000}));
+    EXPECT_EQ(buffer.size(), 16u);
+}
+
+struct pb_person
+{
+    std::string name;
+    zpp::bits::vint32_t id;
+    std::vector<std::string> emails;
+
+    using serialize = zpp::bits::pb_protocol;
+};
+
+TEST(test_sink, sized_message_stays_in_place_until_done)
+{
+    pb_person message{"name", 1337, {}};
+    for (int i = 0; i < 50; ++i) {
+        message.emails.push_back(std::string(i, 'x') + "@example.com");
+    }
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(message).or_throw();
+
+    zpp::bits::sink_buffer buffer{collect{}, 32};
+    zpp::bits::out out{buffer};
+    out(message, message).or_throw();
+
+    // The buffer grows to hold the messages whole, rather than flushing
+    // before their sizes are known.
+    EXPECT_GE(buffer.size(), expected.size());
+    EXPECT_EQ(buffer.sink().sizes(),
+              (std::vector<std::size_t>{2 * expected.size()}));
+
+    auto data = join_segments(buffer.sink().writes);
+    expected.insert(expected.end(), expected.begin(), expected.end());
+    EXPECT_EQ(data, expected);
+}
+
+TEST(test_sink, protobuf_varint_sizes)
+{
+    pb_person message{"name", 1337, {std::string(300, 'y')}};
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected, zpp::bits::size_varint{}}(message).or_throw();
+
+    zpp::bits::sink_buffer buffer{collect{}, 8};
+    zpp::bits::out{buffer, zpp::bits::size_varint{}}(message).or_throw();
+
+    EXPECT_EQ(join_segments(buffer.sink().writes), expected);
+}
+
+TEST(test_sink, sink_failure_is_reported)
+{
+    int calls = 0;
+    zpp::bits::sink_buffer buffer{
+        [&](std::span<const std::byte>) -> zpp::bits::errc {
+            if (++calls == 2) {
+                return std::errc::io_error;
+            }
+            return {};
+        },
+        8};
+
+    zpp::bits::out out{buffer};
+    out(std::uint64_t{1}).or_throw();
+    EXPECT_EQ(out(std::uint64_t{2}), std::errc::io_error);
+    EXPECT_EQ(buffer.flushed(), 8u);
+}
+
+TEST(test_sink, sink_without_result)
+{
+    std::vector<std::byte> written;
+    zpp::bits::sink_buffer buffer{
+        [&](std::span<const std::byte> bytes) {
+            written.insert(written.end(), bytes.begin(), bytes.end());
+        },
+        8};
+
+    zpp::bits::out out{buffer};
+    out(std::uint64_t{1}, std::string("abcdef")).or_throw();
+    EXPECT_EQ(encode_hex(written),
+              "0100000000000000"
+              "06000000616263646566");
+    EXPECT_EQ(buffer.flushed(), written.size());
+}
+
+TEST(test_sink, file_sink)
+{
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    std::vector<std::string> names{"a", std::string(200, 'b'), "c"};
+    zpp::bits::sink_buffer buffer{zpp::bits::file_sink{file}, 128};
+    zpp::bits::out{buffer}(names).or_throw();
+
+    std::vector<std::byte> data(buffer.flushed());
+    std::rewind(file);
+    ASSERT_EQ(std::fread(data.data(), 1, data.size(), file), data.size());
+    std::fclose(file);
+
+    std::vector<std::string> restored;
+    zpp::bits::in{data}(restored).or_throw();
+    EXPECT_EQ(restored, names);
+}
+
+#if __has_include(<unistd.h>)
+TEST(test_sink, fd_sink)
+{
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    std::vector<std::string> names{"a", std::string(200, 'b'), "c"};
+    zpp::bits::sink_buffer buffer{zpp::bits::fd_sink{fileno(file)}, 128};
+    zpp::bits::out{buffer}(names).or_throw();
+
+    std::vector<std::byte> data(buffer.flushed());
+    std::rewind(file);
+    ASSERT_EQ(std::fread(data.data(), 1, data.size(), file), data.size());
+    std::fclose(file);
+
+    std::vector<std::string> restored;
+    zpp::bits::in{data}(restored).or_throw();
+    EXPECT_EQ(restored, names);
+}
+#endif
+
+} // namespace test_sink
@@ -0,0 +1,220 @@
+#include "test.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+#if __has_include(<unistd.h>)
+#include <thread>
+#include <unistd.h>
+#endif
+
+namespace test_source
+{
+
+using fixtures::people;
+using fixtures::person;
+
+struct pb_person
+{
+    std::string name;
+    zpp::bits::vint32_t id;
+    std::vector<std::string> emails;
+
+    using serialize = zpp::bits::pb_protocol;
+};
+
+TEST(test_source, reads_through_small_window)
+{
+    auto items = people();
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(items).or_throw();
+
+    zpp::bits::source_buffer buffer{chunked{data}, 16};
+    zpp::bits::in in{buffer};
+
+    std::vector<person> restored;
+    in(restored).or_throw();
+
+    ASSERT_EQ(restored.size(), items.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        EXPECT_EQ(restored[i].name, items[i].name);
+        EXPECT_EQ(restored[i].numbers, items[i].numbers);
+        EXPECT_EQ(restored[i].id, items[i].id);
+        EXPECT_EQ(restored[i].tags, items[i].tags);
+    }
+}
+
+TEST(test_source, large_payload_is_read_in_place)
+{
+    std::vector<std::byte> payload(1000);
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = std::byte(i);
+    }
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::uint8_t{1}, payload).or_throw();
+
+    zpp::bits::source_buffer buffer{chunked{data, 0x1000}, 16};
+    zpp::bits::in in{buffer};
+
+    std::uint8_t first{};
+    std::vector<std::byte> restored;
+    in(first, restored).or_throw();
+
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(restored, payload);
+    EXPECT_GT(buffer.source().largest, 900u);
+}
+
+TEST(test_source, truncated_input_is_rejected)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(people()).or_throw();
+    data.resize(data.size() - 3);
+
+    zpp::bits::source_buffer buffer{chunked{data}, 16};
+    zpp::bits::in in{buffer};
+
+    std::vector<person> restored;
+    EXPECT_EQ(in(restored), std::errc::result_out_of_range);
+}
+
+TEST(test_source, truncated_payload_is_rejected)
+{
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(std::vector<std::byte>(1000)).or_throw();
+    data.resize(500);
+
+    zpp::bits::source_buffer buffer{chunked{data}, 16};
+    zpp::bits::in in{buffer};
+
+    std::vector<std::byte> restored;
+    EXPECT_EQ(in(restored), std::errc::result_out_of_range);
+}
+
+TEST(test_source, protobuf_messages)
+{
+    std::vector<pb_person> messages;
+    for (int i = 0; i < 10; ++i) {
+        messages.push_back({"name", i, {std::string(100, 'x')}});
+    }
+
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(messages).or_throw();
+
+    zpp::bits::source_buffer buffer{chunked{data}, 16};
+    zpp::bits::in in{buffer};
+
+    std::vector<pb_person> restored;
+    in(restored).or_throw();
+
+    ASSERT_EQ(restored.size(), messages.size());
+    EXPECT_EQ(restored.back().id, 9);
+    EXPECT_EQ(restored.back().emails, messages.back().emails);
+}
+
+TEST(test_source, source_failure_is_reported)
+{
+    zpp::bits::source_buffer buffer{
+        [](std::span<std::byte>) {
+            return zpp::bits::value_or_errc<std::size_t>{
+                zpp::bits::errc{std::errc::io_error}};
+        }};
+    zpp::bits::in in{buffer};
+
+    std::uint32_t value{};
+    EXPECT_EQ(in(value), std::errc::io_error);
+}
+
+// Hands out a vector of one protobuf message that claims to be about 2GiB,
+// followed by as many bytes as asked for, forever.
+struct huge_message
+{
+    std::size_t operator()(std::span<std::byte> bytes)
+    {
+        constexpr std::array<std::byte, 8> header{
+            std::byte{1}, {}, {}, {},
+            std::byte{0xff}, std::byte{0xff}, std::byte{0xff}, std::byte{0x7f}};
+        for (auto & byte : bytes) {
+            byte = position < header.size() ? header[position] : std::byte{};
+            ++position;
+        }
+        return bytes.size();
+    }
+
+    std::size_t position = 0;
+};
+
+TEST(test_source, window_growth_is_bounded)
+{
+    zpp::bits::source_buffer buffer{huge_message{}, 16, 0x1000};
+    zpp::bits::in in{buffer};
+
+    std::vector<pb_person> restored;
+    EXPECT_EQ(in(restored), std::errc::message_size);
+    // The header, and no more than the maximum window after it.
+    EXPECT_LE(buffer.source().position, 8u + 0x1000u);
+}
+
+TEST(test_source, window_growth_is_bounded_by_alloc_limit)
+{
+    zpp::bits::source_buffer buffer{huge_message{}, 16};
+    zpp::bits::in in{buffer, zpp::bits::alloc_limit<0x1000>{}};
+
+    std::vector<pb_person> restored;
+    EXPECT_EQ(in(restored), std::errc::message_size);
+    EXPECT_LE(buffer.source().position, 16u);
+}
+
+TEST(test_source, file_source)
+{
+    auto file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    auto items = people();
+    std::vector<std::byte> data;
+    zpp::bits::out{data}(items).or_throw();
+    ASSERT_EQ(std::fwrite(data.data(), 1, data.size(), file), data.size());
+    std::rewind(file);
+
+    zpp::bits::source_buffer buffer{zpp::bits::file_source{file}, 64};
+    std::vector<person> restored;
+    zpp::bits::in{buffer}(restored).or_throw();
+    std::fclose(file);
+
+    ASSERT_EQ(restored.size(), items.size());
+    EXPECT_EQ(restored.back().name, items.back().name);
+}
+
+#if __has_include(<unistd.h>)
+TEST(test_source, sink_to_source_over_pipe)
+{
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    auto items = people();
+    std::thread writer([&] {
+        zpp::bits::sink_buffer buffer{zpp::bits::fd_sink{fds[1]}, 64};
+        zpp::bits::out{buffer}(items).or_throw();
+        ::close(fds[1]);
+    });
+
+    zpp::bits::source_buffer buffer{zpp::bits::fd_source{fds[0]}, 64};
+    std::vector<person> restored;
+    auto result = zpp::bits::in{buffer}(restored);
+    writer.join();
+    ::close(fds[0]);
+
+    result.or_throw();
+    ASSERT_EQ(restored.size(), items.size());
+    EXPECT_EQ(restored.back().numbers, items.back().numbers);
+}
+#endif
+
+} // namespace test_source
@@ -0,0 +1,202 @@
+#include "test.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace test_typed_view
+{
+
+struct sample
+{
+    std::int32_t time{};
+    float value{};
+};
+
+static bool points_into(std::span<const std::byte> data, const void * pointer)
+{
+    auto address = static_cast<const std::byte *>(pointer);
+    return address >= data.data() && address < data.data() + data.size();
+}
+
+TEST(test_typed_view, floats)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::vector<float>{1.5f, 2.5f, 3.5f}).or_throw();
+
+    std::span<const float> values;
+    in(values).or_throw();
+
+    ASSERT_EQ(values.size(), 3u);
+    EXPECT_EQ(values[0], 1.5f);
+    EXPECT_EQ(values[2], 3.5f);
+    EXPECT_EQ(static_cast<const void *>(values.data()), data.data() + 4);
+    EXPECT_EQ(in.position(), data.size());
+}
+
+TEST(test_typed_view, known_bytes)
+{
+    using namespace zpp::bits::literals;
+
+    // The size, then the smallest, zero and largest values.
+    auto bytes = "03000000"
+                 "00000080"
+                 "00000000"
+                 "ffffff7f"_decode_hex;
+    std::vector<std::byte> data(bytes.begin(), bytes.end());
+
+    std::span<const std::int32_t> values;
+    zpp::bits::in in{data};
+    in(values).or_throw();
+
+    ASSERT_EQ(values.size(), 3u);
+    EXPECT_EQ(static_cast<const void *>(values.data()), data.data() + 4);
+    EXPECT_EQ(values[0], std::numeric_limits<std::int32_t>::min());
+    EXPECT_EQ(values[1], 0);
+    EXPECT_EQ(values[2], std::numeric_limits<std::int32_t>::max());
+    EXPECT_EQ(in.position(), data.size());
+}
+
+TEST(test_typed_view, known_bytes_too_short)
+{
+    using namespace zpp::bits::literals;
+
+    // A size that is one element more than there is, and one that
+    // overflows when counted in bytes.
+    for (auto bytes : {"03000000"
+                       "01000000"
+                       "02000000"
+                       "0300"_decode_hex,
+                       "ffffffff"
+                       "01000000"
+                       "02000000"
+                       "0300"_decode_hex}) {
+        std::vector<std::byte> data(bytes.begin(), bytes.end());
+
+        std::span<const std::int32_t> values;
+        zpp::bits::in in{data};
+        EXPECT_EQ(in(values), std::errc::result_out_of_range);
+        EXPECT_TRUE(values.empty());
+    }
+}
+
+TEST(test_typed_view, structs)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::vector<sample>{{1, 0.5f}, {2, 0.25f}}).or_throw();
+
+    std::span<const sample> samples;
+    in(samples).or_throw();
+
+    ASSERT_EQ(samples.size(), 2u);
+    EXPECT_EQ(samples[1].time, 2);
+    EXPECT_EQ(samples[1].value, 0.25f);
+    EXPECT_EQ(static_cast<const void *>(samples.data()), data.data() + 4);
+}
+
+TEST(test_typed_view, fixed_extent_and_unsized)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::array<std::int32_t, 2>{7, 8},
+        zpp::bits::unsized(std::vector<std::int32_t>{1, 2, 3}))
+        .or_throw();
+
+    std::array<std::int32_t, 2> placeholder{};
+    std::span<const std::int32_t, 2> first{placeholder};
+    std::span<const std::int32_t> rest;
+    in(first, zpp::bits::unsized(rest)).or_throw();
+
+    EXPECT_EQ(first[1], 8);
+    EXPECT_EQ(static_cast<const void *>(first.data()), data.data());
+    ASSERT_EQ(rest.size(), 3u);
+    EXPECT_EQ(rest[2], 3);
+    EXPECT_EQ(static_cast<const void *>(rest.data()), data.data() + 8);
+}
+
+TEST(test_typed_view, misaligned)
+{
+    // The four byte size leaves the doubles misaligned.
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::vector<double>{1.0, 2.0}).or_throw();
+
+    std::span<const double> values;
+    EXPECT_EQ(in(values), std::errc::invalid_argument);
+    EXPECT_EQ(in.position(), sizeof(std::uint32_t));
+}
+
+TEST(test_typed_view, misaligned_with_resource_only)
+{
+    auto [data, out] = zpp::bits::data_out();
+    out(std::vector<double>{1.0, 2.0}).or_throw();
+
+    // A memory resource alone does not make the view copy.
+    std::pmr::monotonic_buffer_resource arena;
+    std::span<const double> values;
+    zpp::bits::in in{data, zpp::bits::memory_resource{&arena}};
+    EXPECT_EQ(in(values), std::errc::invalid_argument);
+    EXPECT_EQ(in.position(), sizeof(std::uint32_t));
+}
+
+TEST(test_typed_view, misaligned_copy)
+{
+    auto [data, out] = zpp::bits::data_out();
+    out(std::vector<double>{1.0, 2.0}).or_throw();
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::span<const double> values;
+    zpp::bits::in in{data,
+                     zpp::bits::memory_resource{&arena},
+                     zpp::bits::copy_misaligned{}};
+    in(values).or_throw();
+
+    ASSERT_EQ(values.size(), 2u);
+    EXPECT_EQ(values[1], 2.0);
+    EXPECT_FALSE(points_into(data, values.data()));
+    EXPECT_EQ(in.position(), data.size());
+}
+
+TEST(test_typed_view, too_short)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::uint32_t{3}, std::int32_t{1}).or_throw();
+
+    std::span<const std::int32_t> values;
+    EXPECT_EQ(in(values), std::errc::result_out_of_range);
+}
+
+// A view that can only be constructed explicitly, so it is not read with a
+// size like a span is.
+struct explicit_view
+{
+    using value_type = const std::int32_t;
+    using iterator = const std::int32_t *;
+
+    explicit_view() = default;
+    explicit explicit_view(const std::int32_t * data, std::size_t size) :
+        m_data(data), m_size(size)
+    {
+    }
+
+    auto data() const { return m_data; }
+    auto size() const { return m_size; }
+    auto begin() const { return m_data; }
+    auto end() const { return m_data + m_size; }
+
+    const std::int32_t * m_data{};
+    std::size_t m_size{};
+};
+
+TEST(test_typed_view, view_without_size_is_rejected)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::vector<std::int32_t>{1, 2}).or_throw();
+
+    explicit_view values;
+    EXPECT_EQ(in(values), std::errc::result_out_of_range);
+    EXPECT_EQ(values.size(), 0u);
+}
+
+} // namespace test_typed_view
@@ -0,0 +1,169 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace test_uninitialized_resize
+{
+
+// A string like type that grows with `resize_and_overwrite()`, as strings
+// do since C++23, handing out room that is filled with junk, and counting
+// the calls.
+struct overwritable_string : std::vector<char>
+{
+    using std::vector<char>::vector;
+
+    template <typename Operation>
+    void resize_and_overwrite(std::size_t count, Operation operation)
+    {
+        ++overwrites;
+        std::vector<char>::resize(count, '?');
+        std::vector<char>::resize(std::size_t(operation(data(), count)));
+    }
+
+    std::size_t overwrites = 0;
+};
+
+TEST(test_uninitialized_resize, byte_vector)
+{
+    std::vector<std::byte> payload(1000);
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = std::byte(i);
+    }
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(payload).or_throw();
+
+    std::vector<std::byte, counting_allocator<std::byte>> restored(
+        3, std::byte{0x7f});
+    counting_allocator<std::byte>::constructed = 0;
+    in(restored).or_throw();
+
+    EXPECT_EQ(counting_allocator<std::byte>::constructed, 0u);
+    EXPECT_TRUE(std::equal(
+        restored.begin(), restored.end(), payload.begin(), payload.end()));
+    EXPECT_EQ(in.position(), data.size());
+}
+
+TEST(test_uninitialized_resize, char_vector_and_string)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::vector<char>{'a', 'b', 'c'},
+        std::string(300, 'x'),
+        std::vector<unsigned char>{1, 2})
+        .or_throw();
+
+    std::vector<char> chars(10, 'z');
+    std::string text = "previous";
+    std::vector<unsigned char> bytes;
+    in(chars, text, bytes).or_throw();
+
+    EXPECT_EQ(chars, (std::vector<char>{'a', 'b', 'c'}));
+    EXPECT_EQ(text, std::string(300, 'x'));
+    EXPECT_EQ(bytes, (std::vector<unsigned char>{1, 2}));
+}
+
+TEST(test_uninitialized_resize, numbers)
+{
+    std::vector<std::int32_t> numbers(10000);
+    for (std::size_t i = 0; i < numbers.size(); ++i) {
+        numbers[i] = std::int32_t(i * 3);
+    }
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(numbers).or_throw();
+
+    // Value initialized by the default allocator.
+    std::vector<std::int32_t, counting_allocator<std::int32_t>> initialized;
+    counting_allocator<std::int32_t>::constructed = 0;
+    in(initialized).or_throw();
+    EXPECT_EQ(counting_allocator<std::int32_t>::constructed, numbers.size());
+
+    in.reset();
+    std::vector<std::int32_t,
+                zpp::bits::default_init_allocator<
+                    std::int32_t,
+                    counting_allocator<std::int32_t>>>
+        restored;
+    counting_allocator<std::int32_t>::constructed = 0;
+    in(restored).or_throw();
+
+    EXPECT_EQ(counting_allocator<std::int32_t>::constructed, 0u);
+    EXPECT_TRUE(std::equal(
+        restored.begin(), restored.end(), numbers.begin(), numbers.end()));
+    EXPECT_EQ(in.position(), data.size());
+}
+
+TEST(test_uninitialized_resize, numbers_beyond_data)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::vector<std::int32_t>(100, 7)).or_throw();
+    data.resize(data.size() - 1);
+
+    std::vector<std::int32_t,
+                zpp::bits::default_init_allocator<std::int32_t>>
+        restored;
+    EXPECT_EQ(in(restored), std::errc::result_out_of_range);
+    EXPECT_TRUE(restored.empty());
+}
+
+TEST(test_uninitialized_resize, size_beyond_data)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::uint32_t{100}, std::byte{1}, std::byte{2}).or_throw();
+
+    std::string text;
+    EXPECT_EQ(in(text), std::errc::result_out_of_range);
+
+    in.reset();
+    std::vector<std::byte> bytes;
+    EXPECT_EQ(in(bytes), std::errc::result_out_of_range);
+}
+
+TEST(test_uninitialized_resize, alloc_limit)
+{
+    auto [data, out] = zpp::bits::data_out();
+    out(std::string(100, 'x')).or_throw();
+
+    std::string text;
+    EXPECT_EQ((zpp::bits::in{data, zpp::bits::alloc_limit<50>{}}(text)),
+              std::errc::message_size);
+}
+
+TEST(test_uninitialized_resize, overwritable_output)
+{
+    overwritable_string data;
+    zpp::bits::out out{data};
+    out(std::string(300, 'x'), std::int32_t{7}).or_throw();
+    EXPECT_GT(data.overwrites, 0u);
+
+    std::vector<std::byte> expected;
+    zpp::bits::out{expected}(std::string(300, 'x'), std::int32_t{7})
+        .or_throw();
+    ASSERT_EQ(data.size(), expected.size());
+    EXPECT_TRUE(std::equal(
+        data.begin(), data.end(), expected.begin(), [](auto left, auto right) {
+            return std::byte(left) == right;
+        }));
+}
+
+TEST(test_uninitialized_resize, overwritable_input)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::string(300, 'x')).or_throw();
+
+    overwritable_string text{'a', 'b'};
+    in(text).or_throw();
+    EXPECT_EQ(text.overwrites, 1u);
+    EXPECT_EQ(text, overwritable_string(300, 'x'));
+
+    in.reset();
+    data.resize(data.size() - 1);
+    EXPECT_EQ(in(text), std::errc::result_out_of_range);
+    EXPECT_EQ(text.overwrites, 2u);
+    EXPECT_TRUE(text.empty());
+}
+
+} // namespace test_uninitialized_resize
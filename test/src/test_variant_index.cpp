@@ -0,0 +1,138 @@
+#include "test.h"
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <variant>
+
+namespace test_variant_index
+{
+using namespace zpp::bits::literals;
+
+template <std::array Keys>
+constexpr bool finds_every_key()
+{
+    using index = zpp::bits::traits::key_index<Keys>;
+    for (std::size_t i = 0; i < Keys.size(); ++i) {
+        if (index::find(Keys[i]) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(variant_index, key_index)
+{
+    constexpr std::array<std::uint64_t, 6> consecutive{3, 4, 5, 6, 7, 8};
+    static_assert(zpp::bits::traits::key_index<consecutive>::consecutive);
+    static_assert(finds_every_key<consecutive>());
+    static_assert(zpp::bits::traits::key_index<consecutive>::find(2) == 6);
+    static_assert(zpp::bits::traits::key_index<consecutive>::find(9) == 6);
+
+    constexpr std::array<std::uint64_t, 6> dense{10, 2, 7, 3, 12, 5};
+    static_assert(zpp::bits::traits::key_index<dense>::range == 11);
+    static_assert(finds_every_key<dense>());
+    static_assert(zpp::bits::traits::key_index<dense>::find(4) == 6);
+    static_assert(zpp::bits::traits::key_index<dense>::find(13) == 6);
+
+    constexpr std::array<std::uint64_t, 8> sparse{
+        0x8a3b1c2d,
+        0x1,
+        0xffffffff'ffffffff,
+        0x5bd1e995,
+        0x9e3779b9'7f4a7c15,
+        0x42,
+        0x1337'0000'0000,
+        0xdeadbeef,
+    };
+    static_assert(!zpp::bits::traits::key_index<sparse>::range);
+    static_assert(finds_every_key<sparse>());
+
+    using sparse_index = zpp::bits::traits::key_index<sparse>;
+    for (std::size_t i = 0; i < sparse.size(); ++i) {
+        EXPECT_EQ(sparse_index::find(sparse[i]), i);
+    }
+    for (std::uint64_t key : {0x0ull, 0x2ull, 0x43ull, 0xdeadbeeeull}) {
+        EXPECT_EQ(sparse_index::find(key), sparse.size());
+    }
+}
+
+template <int Number>
+struct event
+{
+    // Ids of a 32 bit hash, spread over the whole range.
+    using serialize_id =
+        zpp::bits::id<std::uint32_t(0x9e3779b1u * (Number + 1))>;
+
+    int value;
+
+    bool operator==(const event &) const = default;
+};
+
+template <std::size_t... Indices>
+auto events(std::index_sequence<Indices...>) -> std::variant<event<Indices>...>;
+
+using event_variant = decltype(events(std::make_index_sequence<40>{}));
+
+template <std::size_t... Indices>
+void round_trip_every_event(std::index_sequence<Indices...>)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    (out(event_variant{event<Indices>{int(Indices)}}).or_throw(), ...);
+
+    event_variant restored;
+    (
+        [&] {
+            in(restored).or_throw();
+            ASSERT_EQ(restored.index(), Indices);
+            EXPECT_EQ(std::get<Indices>(restored).value, int(Indices));
+        }(),
+        ...);
+    EXPECT_EQ(in.position(), data.size());
+}
+
+TEST(variant_index, many_sparse_ids)
+{
+    round_trip_every_event(std::make_index_sequence<40>{});
+}
+
+TEST(variant_index, unknown_id)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::uint32_t{0x12345678}, 1).or_throw();
+
+    event_variant restored;
+    EXPECT_EQ(in(restored), std::errc::bad_message);
+}
+
+TEST(variant_index, many_default_ids)
+{
+    using variant = std::variant<std::int8_t,
+                                 std::int16_t,
+                                 std::int32_t,
+                                 std::int64_t,
+                                 std::uint8_t,
+                                 std::uint16_t,
+                                 std::uint32_t,
+                                 std::uint64_t>;
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(variant{std::uint16_t{0x1234}}, variant{std::int64_t{-1}})
+        .or_throw();
+    EXPECT_EQ(encode_hex(data),
+              "05"
+              "3412"
+              "03"
+              "ffffffffffffffff");
+
+    variant first;
+    variant second;
+    in(first, second).or_throw();
+    EXPECT_EQ(first, variant{std::uint16_t{0x1234}});
+    EXPECT_EQ(second, variant{std::int64_t{-1}});
+
+    data[0] = std::byte{8};
+    in.reset();
+    EXPECT_EQ(in(first), std::errc::bad_message);
+}
+
+} // namespace test_variant_index
@@ -1,4 +1,9 @@
 #include "test.h"
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
 
 namespace test_varint
 {
@@ -198,4 +203,147 @@ TEST(varint, varint_size)
     EXPECT_EQ(v, o);
 }
 
+// Encodes a byte at a time, the way the format is specified.
+static std::vector<std::byte> reference_encoding(std::uint64_t value)
+{
+    std::vector<std::byte> bytes;
+    while (value >= 0x80) {
+        bytes.push_back(std::byte((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(std::byte(value));
+    return bytes;
+}
+
+template <typename Varint>
+static void every_length()
+{
+    using type = typename Varint::value_type;
+    using unsigned_type = std::make_unsigned_t<type>;
+    constexpr auto bits = sizeof(type) * CHAR_BIT;
+
+    std::vector<unsigned_type> values{0, unsigned_type(~unsigned_type{})};
+    for (std::size_t bit = 0; bit < bits; ++bit) {
+        values.push_back(unsigned_type(unsigned_type{1} << bit));
+        values.push_back(unsigned_type((unsigned_type{1} << bit) - 1));
+        values.push_back(unsigned_type((unsigned_type{1} << bit) | 1));
+    }
+
+    for (auto value : values) {
+        auto expected = reference_encoding(value);
+
+        // With room for whole words, and with room for the varint only.
+        for (auto room : {std::size_t{32}, expected.size()}) {
+            std::vector<std::byte> data(room);
+            zpp::bits::out out{data};
+            out(Varint{type(value)}).or_throw();
+            EXPECT_EQ(out.position(), expected.size());
+            EXPECT_TRUE(std::equal(
+                expected.begin(), expected.end(), data.begin()));
+
+            Varint restored{};
+            zpp::bits::in in{data};
+            in(restored).or_throw();
+            EXPECT_EQ(type(restored), type(value));
+            EXPECT_EQ(in.position(), expected.size());
+        }
+    }
+}
+
+TEST(varint, every_length)
+{
+    every_length<zpp::bits::vuint64_t>();
+    every_length<zpp::bits::vint64_t>();
+    every_length<zpp::bits::vuint32_t>();
+    every_length<zpp::bits::vint32_t>();
+    every_length<zpp::bits::varint<std::uint16_t>>();
+    every_length<zpp::bits::varint<std::uint8_t>>();
+}
+
+TEST(varint, span_keeps_bytes_past_the_end)
+{
+    for (auto value : {std::uint64_t{1}, std::uint64_t{150},
+                       std::uint64_t{1} << 40, ~std::uint64_t{}}) {
+        auto expected = reference_encoding(value);
+
+        // The bytes past the varint belong to the caller.
+        std::vector<std::byte> data(expected.size() + 16, std::byte{0xcc});
+        zpp::bits::out out{std::span{data}};
+        out(zpp::bits::vuint64_t{value}).or_throw();
+        EXPECT_EQ(out.position(), expected.size());
+        EXPECT_TRUE(
+            std::equal(expected.begin(), expected.end(), data.begin()));
+        EXPECT_TRUE(std::all_of(data.begin() + expected.size(),
+                                data.end(),
+                                [](auto byte) {
+                                    return byte == std::byte{0xcc};
+                                }));
+
+        zpp::bits::vuint64_t restored;
+        zpp::bits::in in{std::span{std::as_const(data)}};
+        in(restored).or_throw();
+        EXPECT_EQ(restored, value);
+        EXPECT_EQ(in.position(), expected.size());
+    }
+}
+
+TEST(varint, rewrite_keeps_bytes_past_the_end)
+{
+    for (auto value : {std::uint64_t{1}, std::uint64_t{150},
+                       std::uint64_t{1} << 40, ~std::uint64_t{}}) {
+        auto expected = reference_encoding(value);
+
+        // The bytes that the vector already holds belong to the caller.
+        std::vector<std::byte> data(expected.size() + 16, std::byte{0xcc});
+        zpp::bits::out out{data, zpp::bits::no_fit_size{}};
+        out.reset(0);
+        out(zpp::bits::vuint64_t{value}).or_throw();
+        EXPECT_EQ(out.position(), expected.size());
+        EXPECT_EQ(data.size(), expected.size() + 16);
+        EXPECT_TRUE(
+            std::equal(expected.begin(), expected.end(), data.begin()));
+        EXPECT_TRUE(std::all_of(data.begin() + expected.size(),
+                                data.end(),
+                                [](auto byte) {
+                                    return byte == std::byte{0xcc};
+                                }));
+
+        // So do the bytes written before moving the position back.
+        std::vector<std::byte> written;
+        zpp::bits::out rewritten{written};
+        rewritten(zpp::bits::vuint64_t{value}, std::uint64_t{}).or_throw();
+        rewritten.reset(0);
+        rewritten(zpp::bits::vuint32_t{1}).or_throw();
+        EXPECT_EQ(rewritten.position(), 1u);
+        EXPECT_EQ(written.size(), expected.size() + sizeof(std::uint64_t));
+        EXPECT_EQ(written[0], std::byte{0x01});
+        EXPECT_TRUE(std::equal(expected.begin() + 1,
+                               expected.end(),
+                               written.begin() + 1));
+    }
+}
+
+TEST(varint, too_long)
+{
+    // Eleven bytes for a 64 bit varint, and six for a 32 bit one, each
+    // followed by more input.
+    std::vector<std::byte> data(13, std::byte{0x80});
+    data[10] = std::byte{0x01};
+    data[11] = std::byte{};
+    data[12] = std::byte{};
+
+    zpp::bits::vuint64_t long_value;
+    EXPECT_EQ(zpp::bits::in{data}(long_value), std::errc::value_too_large);
+
+    data.erase(data.begin(), data.begin() + 5);
+    zpp::bits::vuint32_t short_value;
+    EXPECT_EQ(zpp::bits::in{data}(short_value), std::errc::value_too_large);
+
+    // The tenth byte of a 64 bit varint holds a single bit.
+    auto encoded = reference_encoding(~std::uint64_t{});
+    encoded.resize(16);
+    zpp::bits::in{encoded}(long_value).or_throw();
+    EXPECT_EQ(long_value, ~std::uint64_t{});
+}
+
 } // namespace test_varint
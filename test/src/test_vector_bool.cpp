@@ -0,0 +1,95 @@
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace test_vector_bool
+{
+
+static std::vector<bool> flags(std::size_t count)
+{
+    std::vector<bool> flags(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        flags[i] = (i % 3 == 0) || (i % 11 == 0);
+    }
+    return flags;
+}
+
+TEST(test_vector_bool, packed)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::vector<bool>{true, false, true, true, false, false, false, false,
+                          false, true})
+        .or_throw();
+    EXPECT_EQ(encode_hex(data), "0a0000000d02");
+
+    std::vector<bool> restored(3, true);
+    in(restored).or_throw();
+    EXPECT_EQ(restored,
+              (std::vector<bool>{true, false, true, true, false, false,
+                                 false, false, false, true}));
+}
+
+TEST(test_vector_bool, many)
+{
+    for (std::size_t count : {0, 1, 8, 9, 63, 64, 65, 40000}) {
+        auto o = flags(count);
+
+        auto [data, in, out] = zpp::bits::data_in_out(zpp::bits::size_varint{});
+        out(o).or_throw();
+        EXPECT_EQ(data.size(),
+                  zpp::bits::varint_size(count) + (count + 7) / 8);
+
+        std::vector<bool> i;
+        in(i).or_throw();
+        EXPECT_EQ(o, i);
+    }
+}
+
+TEST(test_vector_bool, unsized)
+{
+    auto o = flags(20);
+
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(zpp::bits::unsized(o)).or_throw();
+    EXPECT_EQ(data.size(), 3u);
+
+    std::vector<bool> i(20);
+    in(zpp::bits::unsized(i)).or_throw();
+    EXPECT_EQ(o, i);
+}
+
+TEST(test_vector_bool, missing_bytes)
+{
+    auto [data, in, out] = zpp::bits::data_in_out();
+    out(std::uint32_t{100}, std::byte{0xff}).or_throw();
+
+    std::vector<bool> i;
+    EXPECT_EQ(in(i), std::errc::result_out_of_range);
+    EXPECT_TRUE(i.empty());
+}
+
+TEST(test_vector_bool, alloc_limit)
+{
+    auto [data, out] = zpp::bits::data_out();
+    out(flags(1000)).or_throw();
+
+    std::vector<bool> i;
+    EXPECT_EQ((zpp::bits::in{data, zpp::bits::alloc_limit<100>{}}(i)),
+              std::errc::message_size);
+}
+
+TEST(test_vector_bool, memory_resource)
+{
+    auto [data, out] = zpp::bits::data_out();
+    out(flags(1000)).or_throw();
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<bool> i;
+    zpp::bits::in{data, zpp::bits::memory_resource{&arena}}(i).or_throw();
+    EXPECT_EQ(i.get_allocator().resource(), &arena);
+    EXPECT_TRUE(std::equal(i.begin(), i.end(), flags(1000).begin()));
+}
+
+} // namespace test_vector_bool
@@ -10,14 +10,17 @@
 #if __cpp_lib_tuple_like < 202311L
 #include <complex>
 #endif
+#include <cerrno>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
 #include <optional>
 #include <span>
@@ -36,6 +39,40 @@
 #include <stdexcept>
 #endif
 
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#endif
+
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#endif
+
+#if __has_include(<sys/mman.h>) && __has_include(<sys/stat.h>) && \
+    __has_include(<fcntl.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define ZPP_BITS_HAS_MMAP (1)
+#else
+#define ZPP_BITS_HAS_MMAP (0)
+#endif
+
+#if (defined __x86_64__ || defined __i386__) &&                             \
+    (defined __clang__ || defined __GNUC__) && __has_include(<immintrin.h>)
+#include <immintrin.h>
+#define ZPP_BITS_HAS_X86_SHUFFLE (1)
+#else
+#define ZPP_BITS_HAS_X86_SHUFFLE (0)
+#endif
+
+#ifndef ZPP_BITS_HAS_BMI2
+#if ZPP_BITS_HAS_X86_SHUFFLE && defined __BMI2__
+#define ZPP_BITS_HAS_BMI2 (1)
+#else
+#define ZPP_BITS_HAS_BMI2 (0)
+#endif
+#endif
+
 #ifndef ZPP_BITS_AUTODETECT_MEMBERS_MODE
 #define ZPP_BITS_AUTODETECT_MEMBERS_MODE (0)
 #endif
@@ -167,6 +204,9 @@ constexpr auto failure(errc code)
     return std::errc{} != code;
 }
 
+template <typename Type>
+struct value_or_errc;
+
 struct access
 {
     struct any
@@ -409,6 +449,37 @@ struct destructor_guard
 template <typename Type>
 destructor_guard(Type) -> destructor_guard<Type>;
 
+// Destroys and deallocates an object that was allocated from a memory
+// resource, which lets owning pointers be loaded from a pool or an arena,
+// such as the memory resource of an input archive.
+template <typename Type>
+struct pmr_delete
+{
+    pmr_delete() noexcept = default;
+
+    constexpr explicit pmr_delete(
+        std::pmr::memory_resource * resource) noexcept :
+        resource(resource)
+    {
+    }
+
+    void operator()(Type * pointer) const
+    {
+        std::destroy_at(pointer);
+        std::pmr::polymorphic_allocator<Type>{resource}.deallocate(pointer,
+                                                                   1);
+    }
+
+    std::pmr::memory_resource * resource =
+        std::pmr::get_default_resource();
+};
+
+template <typename Type>
+using pmr_unique_ptr = std::unique_ptr<Type, pmr_delete<Type>>;
+
+template <typename Type, typename Deleter = std::default_delete<Type>>
+struct optional_ptr;
+
 namespace traits
 {
 template <typename Type>
@@ -422,16 +493,205 @@ struct is_unique_ptr<std::unique_ptr<Type, std::default_delete<Type>>>
 {
 };
 
+template <typename Type>
+struct is_unique_ptr<std::unique_ptr<Type, pmr_delete<Type>>>
+    : std::true_type
+{
+};
+
 template <typename Type>
 struct is_shared_ptr : std::false_type
 {
 };
 
+template <typename Type>
+struct is_optional_ptr : std::false_type
+{
+};
+
+template <typename Type, typename Deleter>
+struct is_optional_ptr<optional_ptr<Type, Deleter>> : std::true_type
+{
+};
+
 template <typename Type>
 struct is_shared_ptr<std::shared_ptr<Type>> : std::true_type
 {
 };
 
+// Finds the position of a key among distinct keys known at compile time
+// without comparing it against each of them in turn, unless there are only
+// a few. Keys that are dense are looked up by their offset from the
+// smallest, directly or through a table. Other keys are looked up through
+// a perfect hash found at compile time: a first hash of the key picks a
+// bucket, and a displacement stored for the bucket seeds a second hash
+// that takes every key of the bucket to a slot of its own. A key that is
+// not among them is found at `Keys.size()`.
+template <std::array Keys>
+struct key_index
+{
+    constexpr static auto size = Keys.size();
+
+    using key_type = typename decltype(Keys)::value_type;
+    using index_type = std::conditional_t<
+        (size < 0xff),
+        std::uint8_t,
+        std::conditional_t<(size < 0xffff), std::uint16_t, std::uint32_t>>;
+
+    constexpr static auto few = 4;
+
+    constexpr static key_type min_key = [] {
+        key_type min_key = Keys[0];
+        for (auto key : Keys) {
+            min_key = std::min(min_key, key);
+        }
+        return min_key;
+    }();
+
+    constexpr static std::size_t range = [] {
+        key_type max_key = Keys[0];
+        for (auto key : Keys) {
+            max_key = std::max(max_key, key);
+        }
+        return max_key - min_key < 4 * size ? max_key - min_key + 1 : 0;
+    }();
+
+    constexpr static bool consecutive = [] {
+        for (std::size_t index = 0; index < size; ++index) {
+            if (Keys[index] != key_type(min_key + index)) {
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    constexpr static auto dense_table = [] {
+        std::array<index_type, range> indices{};
+        std::fill(indices.begin(), indices.end(), index_type(size));
+        if constexpr (range != 0) {
+            for (std::size_t index = 0; index < size; ++index) {
+                indices[Keys[index] - min_key] = index_type(index);
+            }
+        }
+        return indices;
+    }();
+
+    constexpr static std::size_t slots = std::bit_ceil(size) * 2;
+    constexpr static std::size_t buckets = std::bit_ceil(size) / 2 + 1;
+
+    constexpr static std::uint64_t hash(std::uint64_t key,
+                                        std::uint64_t seed)
+    {
+        key ^= seed;
+        key = (key ^ (key >> 33)) * 0xff51afd7'ed558ccd;
+        key = (key ^ (key >> 33)) * 0xc4ceb9fe'1a85ec53;
+        return key ^ (key >> 33);
+    }
+
+    constexpr static std::size_t bucket(key_type key)
+    {
+        return hash(std::uint64_t(key), 0) % buckets;
+    }
+
+    constexpr static std::size_t slot(key_type key,
+                                      std::uint32_t displacement)
+    {
+        return hash(std::uint64_t(key),
+                    (displacement + 1) * 0x9e3779b9'7f4a7c15) &
+               (slots - 1);
+    }
+
+    // A template, so that it is only computed for keys that need it.
+    template <typename = void>
+    constexpr static auto hash_table = [] {
+        struct
+        {
+            std::array<std::uint32_t, buckets> displacements{};
+            std::array<index_type, slots> indices{};
+            bool found = true;
+        } table;
+        std::fill(
+            table.indices.begin(), table.indices.end(), index_type(size));
+
+        // The buckets of the most keys are placed first, while most slots
+        // are still free.
+        std::array<std::size_t, size> order{};
+        for (std::size_t index = 0; index < size; ++index) {
+            order[index] = index;
+        }
+        std::array<std::size_t, buckets> counts{};
+        for (auto key : Keys) {
+            ++counts[bucket(key)];
+        }
+        std::sort(order.begin(), order.end(), [&](auto left, auto right) {
+            auto left_bucket = bucket(Keys[left]);
+            auto right_bucket = bucket(Keys[right]);
+            if (counts[left_bucket] != counts[right_bucket]) {
+                return counts[left_bucket] > counts[right_bucket];
+            }
+            return left_bucket < right_bucket;
+        });
+
+        for (std::size_t first = 0; first < size;) {
+            auto current = bucket(Keys[order[first]]);
+            auto last = first + counts[current];
+            for (std::uint32_t displacement = 0;; ++displacement) {
+                if (displacement == 0x10000) {
+                    table.found = false;
+                    return table;
+                }
+
+                auto placed = first;
+                for (; placed < last; ++placed) {
+                    auto & index =
+                        table.indices[slot(Keys[order[placed]], displacement)];
+                    if (index != size) {
+                        break;
+                    }
+                    index = index_type(order[placed]);
+                }
+                if (placed == last) {
+                    table.displacements[current] = displacement;
+                    break;
+                }
+
+                // Undo the keys placed before the collision.
+                while (placed-- > first) {
+                    table.indices[slot(Keys[order[placed]], displacement)] =
+                        index_type(size);
+                }
+            }
+            first = last;
+        }
+        return table;
+    }();
+
+    ZPP_BITS_INLINE constexpr static std::size_t find(key_type key)
+    {
+        if constexpr (consecutive) {
+            auto index = std::size_t(key_type(key - min_key));
+            return index < size ? index : size;
+        } else if constexpr (size <= few) {
+            for (std::size_t index = 0; index < size; ++index) {
+                if (Keys[index] == key) {
+                    return index;
+                }
+            }
+            return size;
+        } else if constexpr (range) {
+            auto offset = std::size_t(key_type(key - min_key));
+            return offset < range ? dense_table[offset] : size;
+        } else {
+            constexpr auto & table = hash_table<>;
+            // Otherwise there is no perfect hash for the keys.
+            static_assert(table.found);
+            std::size_t index =
+                table.indices[slot(key, table.displacements[bucket(key)])];
+            return index < size && Keys[index] == key ? index : size;
+        }
+    }
+};
+
 template <typename Variant>
 struct variant_impl;
 
@@ -503,10 +763,29 @@ struct variant_impl<Variant<Types...>>
         }
     }
 
+    template <std::size_t... Indices>
+    constexpr static auto keys(std::index_sequence<Indices...>)
+    {
+        return std::array<std::uint64_t, sizeof...(Indices)>{
+            std::uint64_t(id<Indices>())...};
+    }
+
     template <std::size_t CurrentIndex = 0>
     ZPP_BITS_INLINE constexpr static std::size_t index(auto && id)
     {
-        if constexpr (CurrentIndex == sizeof...(Types)) {
+        if constexpr (CurrentIndex == 0 &&
+                      std::same_as<std::remove_cvref_t<decltype(id)>,
+                                   id_type> &&
+                      (std::is_integral_v<id_type> ||
+                       std::is_enum_v<id_type>)) {
+            auto index = key_index<keys(std::make_index_sequence<
+                                        sizeof...(Types)>())>::
+                find(std::uint64_t(id));
+            if (index == sizeof...(Types)) [[unlikely]] {
+                return std::numeric_limits<std::size_t>::max();
+            }
+            return index;
+        } else if constexpr (CurrentIndex == sizeof...(Types)) {
             return std::numeric_limits<std::size_t>::max();
         } else {
             if (variant_impl::id<CurrentIndex>() == id) {
@@ -594,7 +873,10 @@ struct tuple<Tuple<Types...>>
     template <std::size_t Index = 0>
     ZPP_BITS_INLINE constexpr static auto visit(auto && tuple, auto && index, auto && visitor)
     {
-        if constexpr (Index + 1 == sizeof...(Types)) {
+        if constexpr (Index == 0 && sizeof...(Types) > 4) {
+            return visit_through_table(
+                tuple, index, visitor, std::index_sequence_for<Types...>{});
+        } else if constexpr (Index + 1 == sizeof...(Types)) {
             return visitor(std::get<Index>(tuple));
         } else {
             if (Index == index) {
@@ -603,6 +885,24 @@ struct tuple<Tuple<Types...>>
             return visit<Index + 1>(tuple, index, visitor);
         }
     }
+
+    // Jumps to the element through a table rather than comparing the index
+    // against each element in turn.
+    template <std::size_t... Indices>
+    ZPP_BITS_INLINE constexpr static auto
+    visit_through_table(auto & tuple,
+                        auto index,
+                        auto & visitor,
+                        std::index_sequence<Indices...>)
+    {
+        using tuple_type = decltype(tuple);
+        using visitor_type = decltype(visitor);
+        constexpr std::array visitors{
+            +[](tuple_type tuple, visitor_type visitor) {
+                return visitor(std::get<Indices>(tuple));
+            }...};
+        return visitors[std::size_t(index)](tuple, visitor);
+    }
 };
 
 template <typename Type, typename Visitor = std::monostate>
@@ -612,6 +912,7 @@ struct visitor
     using view_type = std::span<std::byte>;
 
     static constexpr bool resizable = false;
+    static constexpr bool prechecked = false;
 
     constexpr auto operator()(auto && ... arguments) const
     {
@@ -732,6 +1033,30 @@ constexpr auto nesting_limit()
     }
 }
 
+template <typename Option, typename... Options>
+constexpr auto get_alignment()
+{
+    if constexpr (requires {
+                      std::remove_cvref_t<Option>::alignment_value;
+                  }) {
+        return std::remove_cvref_t<Option>::alignment_value;
+    } else if constexpr (sizeof...(Options) != 0) {
+        return get_alignment<Options...>();
+    } else {
+        return std::size_t{1};
+    }
+}
+
+template <typename... Options>
+constexpr auto alignment()
+{
+    if constexpr (sizeof...(Options) != 0) {
+        return get_alignment<Options...>();
+    } else {
+        return std::size_t{1};
+    }
+}
+
 // Occupies no space in an archive that was not given a nesting limit.
 struct no_nesting_depth
 {
@@ -743,6 +1068,24 @@ using nesting_depth_t =
                        std::size_t,
                        no_nesting_depth>;
 
+// Occupies no space in an archive over a view that keeps every byte written
+// to it in place.
+struct no_pin_count
+{
+};
+
+// Occupies no space in an archive over a view that does not grow, where
+// none of the bytes are room of the archive.
+struct no_high_water
+{
+};
+
+// Occupies no space in an input archive that was not given a memory
+// resource.
+struct no_memory_resource
+{
+};
+
 template <typename Option, typename... Options>
 constexpr auto get_enlarger()
 {
@@ -866,6 +1209,35 @@ concept associative_container = container<Type> && requires(Type container)
     typename std::remove_cvref_t<Type>::key_type;
 };
 
+// Associative containers that keep their keys and mapped values in two
+// sequences of their own, such as `std::flat_map`.
+template <typename Type>
+concept flat_map = associative_container<Type> &&
+    requires(std::remove_cvref_t<Type> container,
+             typename std::remove_cvref_t<Type>::containers containers)
+{
+    container.keys();
+    container.values();
+    containers = std::move(container).extract();
+    container.replace(std::move(containers.keys),
+                      std::move(containers.values));
+    std::remove_cvref_t<Type>(std::move(containers.keys),
+                              std::move(containers.values),
+                              container.key_comp());
+};
+
+// Associative containers that keep their keys in a sequence of their own,
+// such as `std::flat_set`.
+template <typename Type>
+concept flat_set = associative_container<Type> && !flat_map<Type> &&
+    requires(std::remove_cvref_t<Type> container,
+             typename std::remove_cvref_t<Type>::container_type elements)
+{
+    elements = std::move(container).extract();
+    container.replace(std::move(elements));
+    std::remove_cvref_t<Type>(std::move(elements), container.key_comp());
+};
+
 template <typename Type>
 concept tuple = !has_serialize<Type> && !container<Type> && requires(Type tuple)
 {
@@ -891,6 +1263,18 @@ concept bitset =
     bitset.to_ullong();
 };
 
+// Containers of bits, such as `std::vector<bool>`, whose elements are
+// reached through a proxy rather than a reference.
+template <typename Type>
+concept bit_container = container<Type> &&
+    std::same_as<typename std::remove_cvref_t<Type>::value_type, bool> &&
+    !std::is_reference_v<typename std::remove_cvref_t<Type>::reference> &&
+    requires(std::remove_cvref_t<Type> container)
+{
+    container.assign(1, false);
+    container[0];
+};
+
 template <typename Type>
 concept has_protocol = access::has_protocol<Type>();
 
@@ -930,6 +1314,13 @@ template <typename Archive, typename Type>
 concept serialize_as_bytes = endian_independent_byte_serializable<Type> ||
     (!endian_aware_archive<Archive> && byte_serializable<Type>);
 
+template <typename Archive, typename Type>
+concept serialize_as_swapped_bytes = endian_aware_archive<Archive> &&
+    !serialize_as_bytes<Archive, Type> &&
+    (std::is_arithmetic_v<std::remove_cv_t<Type>> ||
+     std::is_enum_v<std::remove_cv_t<Type>>) &&
+    (sizeof(Type) == 2 || sizeof(Type) == 4 || sizeof(Type) == 8);
+
 template <typename Type, typename Reference>
 concept type_references = requires
 {
@@ -951,7 +1342,8 @@ concept type_references = requires
 }
 || requires (Type && value)
 {
-    requires owning_pointer<Type>;
+    requires owning_pointer<Type> ||
+        traits::is_optional_ptr<std::remove_cvref_t<Type>>::value;
     requires std::same_as<std::remove_cvref_t<decltype(*value)>,
                           std::remove_cvref_t<Reference>>;
 }
@@ -1161,6 +1553,42 @@ struct nesting_limit : option<nesting_limit<Size>>
     constexpr static auto nesting_limit_value = Size;
 };
 
+// Allocates what an input archive creates while reading from the given
+// memory resource, such as an arena that is released at once with the
+// message. Containers with a polymorphic allocator are switched to this
+// resource before they are filled, and shared pointers are allocated from
+// it.
+struct memory_resource : option<memory_resource>
+{
+    constexpr explicit memory_resource(std::pmr::memory_resource * resource) :
+        resource(resource)
+    {
+    }
+    std::pmr::memory_resource * resource{};
+};
+
+// Lets typed views of the input, such as `std::span<const float>`, copy
+// elements that are not aligned in the input into memory from the memory
+// resource of the archive, rather than fail. The archive must be given a
+// memory resource as well. A view does not own what it points to, so the
+// copies are never deallocated, and are only released along with the
+// resource, which should thus be monotonic, such as an arena.
+struct copy_misaligned : option<copy_misaligned>
+{
+};
+
+// Pads with zero bytes ahead of fundamental types, and of the contents of
+// types that serialize as bytes, so that they start at a multiple of their
+// alignment from the beginning of the data, though not of more than
+// `Alignment`. Typed views of the input, such as `std::span<const float>`,
+// can then point into it. Both sides must be given the same option.
+template <std::size_t Alignment = alignof(std::max_align_t)>
+struct aligned : option<aligned<Alignment>>
+{
+    static_assert(std::has_single_bit(Alignment));
+    constexpr static auto alignment_value = Alignment;
+};
+
 template <std::size_t Multiplier, std::size_t Divisor = 1>
 struct enlarger : option<enlarger<Multiplier, Divisor>>
 {
@@ -1531,10 +1959,10 @@ constexpr decltype(auto) visit_members_types(auto && visitor)
     return access::visit_members_types<Type>(visitor);
 }
 
-template <typename Type>
-struct optional_ptr : std::unique_ptr<Type>
+template <typename Type, typename Deleter>
+struct optional_ptr : std::unique_ptr<Type, Deleter>
 {
-    using base = std::unique_ptr<Type>;
+    using base = std::unique_ptr<Type, Deleter>;
     using base::base;
     using base::operator=;
 
@@ -1547,13 +1975,14 @@ struct optional_ptr : std::unique_ptr<Type>
 template <typename Type, typename...>
 optional_ptr(Type *) -> optional_ptr<Type>;
 
-template <typename Type, typename...>
-optional_ptr(std::unique_ptr<Type>) -> optional_ptr<Type>;
+template <typename Type, typename Deleter>
+optional_ptr(std::unique_ptr<Type, Deleter>) -> optional_ptr<Type, Deleter>;
 
-template <typename Archive, typename Type>
+template <typename Archive, typename Type, typename Deleter>
 ZPP_BITS_INLINE constexpr static auto serialize(
     Archive & archive,
-    const optional_ptr<Type> & self) requires(Archive::kind() == kind::out)
+    const optional_ptr<Type, Deleter> & self) requires(Archive::kind() ==
+                                                       kind::out)
 {
     if (!self) [[unlikely]] {
         return archive(std::byte(false));
@@ -1562,10 +1991,11 @@ ZPP_BITS_INLINE constexpr static auto serialize(
     }
 }
 
-template <typename Archive, typename Type>
+template <typename Archive, typename Type, typename Deleter>
 ZPP_BITS_INLINE constexpr static auto
 serialize(Archive & archive,
-          optional_ptr<Type> & self) requires(Archive::kind() == kind::in)
+          optional_ptr<Type, Deleter> & self) requires(Archive::kind() ==
+                                                       kind::in)
 {
     std::byte has_value{};
     if (auto result = archive(has_value); failure(result))
@@ -1579,7 +2009,7 @@ serialize(Archive & archive,
     }
 
     if (auto result =
-            archive(static_cast<std::unique_ptr<Type> &>(self));
+            archive(static_cast<std::unique_ptr<Type, Deleter> &>(self));
         failure(result)) [[unlikely]] {
         return result;
     }
@@ -1736,6 +2166,142 @@ template <typename Type>
 constexpr auto varint_max_size = sizeof(Type) * CHAR_BIT / (CHAR_BIT - 1) +
                                  1;
 
+namespace traits
+{
+constexpr auto unbounded_size = std::numeric_limits<std::size_t>::max();
+
+// Marks an output archive whose room was checked in advance against the
+// maximum size of everything it serializes, so it writes without checks.
+struct prechecked_bounds : option<prechecked_bounds>
+{
+};
+
+template <typename Type>
+constexpr std::size_t max_serialized_size();
+
+struct max_serialized_size_visitor
+{
+    template <typename... Types>
+    constexpr auto operator()()
+    {
+        if constexpr ((... ||
+                       (max_serialized_size<Types>() == unbounded_size))) {
+            return std::integral_constant<std::size_t, unbounded_size>{};
+        } else {
+            return std::integral_constant<
+                std::size_t,
+                (0 + ... + max_serialized_size<Types>())>{};
+        }
+    }
+};
+
+template <typename Type, std::size_t... Indices>
+constexpr std::size_t
+max_serialized_alternative_size(std::index_sequence<Indices...>)
+{
+    return std::max(
+        {max_serialized_size<std::variant_alternative_t<Indices, Type>>()...});
+}
+
+template <typename Type, std::size_t... Indices>
+constexpr std::size_t
+max_serialized_tuple_size(std::index_sequence<Indices...>)
+{
+    return max_serialized_size_visitor{}
+        .template operator()<std::tuple_element_t<Indices, Type>...>()();
+}
+
+// The largest number of bytes that an item of the type may serialize into,
+// or `unbounded_size` if it is not known at compile time - containers,
+// pointers, protocols and types that serialize themselves explicitly.
+template <typename Type>
+constexpr std::size_t max_serialized_size()
+{
+    using type = std::remove_cvref_t<Type>;
+
+    if constexpr (concepts::varint<type>) {
+        return varint_max_size<typename type::value_type>;
+    } else if constexpr (concepts::has_explicit_serialize<type> ||
+                         concepts::by_protocol<type>) {
+        return unbounded_size;
+    } else if constexpr (std::is_fundamental_v<type> ||
+                         std::is_enum_v<type>) {
+        return sizeof(type);
+    } else if constexpr (concepts::empty<type>) {
+        return 0;
+    } else if constexpr (concepts::bitset<type>) {
+        return (type{}.size() + (CHAR_BIT - 1)) / CHAR_BIT;
+    } else if constexpr (concepts::optional<type>) {
+        constexpr auto value_size =
+            max_serialized_size<typename type::value_type>();
+        if constexpr (value_size == unbounded_size) {
+            return unbounded_size;
+        } else {
+            return sizeof(std::byte) + value_size;
+        }
+    } else if constexpr (concepts::expected<type>) {
+        constexpr auto value_size = [] {
+            if constexpr (std::is_void_v<typename type::value_type>) {
+                return std::size_t{};
+            } else {
+                return max_serialized_size<typename type::value_type>();
+            }
+        }();
+        constexpr auto error_size =
+            max_serialized_size<typename type::error_type>();
+        if constexpr (value_size == unbounded_size ||
+                      error_size == unbounded_size) {
+            return unbounded_size;
+        } else {
+            return sizeof(std::byte) + std::max(value_size, error_size);
+        }
+    } else if constexpr (concepts::variant<type>) {
+        constexpr auto id_size =
+            max_serialized_size<typename variant<type>::id_type>();
+        constexpr auto alternative_size =
+            max_serialized_alternative_size<type>(
+                std::make_index_sequence<std::variant_size_v<type>>());
+        if constexpr (id_size == unbounded_size ||
+                      alternative_size == unbounded_size) {
+            return unbounded_size;
+        } else {
+            return id_size + alternative_size;
+        }
+    } else if constexpr (concepts::array<type>) {
+        using value_type =
+            std::remove_cvref_t<decltype(std::declval<type &>()[0])>;
+        constexpr auto count = sizeof(type) / sizeof(value_type);
+        constexpr auto value_size = max_serialized_size<value_type>();
+        if constexpr (value_size == unbounded_size) {
+            return unbounded_size;
+        } else {
+            return count * value_size;
+        }
+    } else if constexpr (concepts::container<type> ||
+                         concepts::owning_pointer<type> ||
+                         std::is_pointer_v<type>) {
+        return unbounded_size;
+    } else if constexpr (concepts::tuple<type>) {
+        return max_serialized_tuple_size<type>(
+            std::make_index_sequence<std::tuple_size_v<type>>());
+    } else if constexpr (number_of_members<type>() > 0) {
+        return visit_members_types<type>(max_serialized_size_visitor{})();
+    } else {
+        return unbounded_size;
+    }
+}
+} // namespace traits
+
+namespace concepts
+{
+template <typename Type>
+concept bounded_serialized_size =
+    traits::max_serialized_size<Type>() != traits::unbounded_size;
+} // namespace concepts
+
+template <concepts::bounded_serialized_size Type>
+constexpr auto max_serialized_size_v = traits::max_serialized_size<Type>();
+
 template <varint_encoding Encoding = varint_encoding::normal>
 ZPP_BITS_INLINE constexpr auto varint_size(auto value)
 {
@@ -1751,67 +2317,250 @@ ZPP_BITS_INLINE constexpr auto varint_size(auto value)
     }
 }
 
-template <typename Archive, typename Type, varint_encoding Encoding>
-ZPP_BITS_INLINE constexpr auto serialize(
-    Archive & archive,
-    varint<Type, Encoding> self) requires(Archive::kind() == kind::out)
+// Spreads the low 56 bits of a value into the low seven bits of each byte
+// of a little endian word, the way a varint lays them out.
+constexpr std::uint64_t varint_expand(std::uint64_t value)
 {
-    auto orig_value = std::conditional_t<std::is_enum_v<Type>,
-                                         traits::underlying_type_t<Type>,
-                                         Type>(self.value);
-    auto value = std::make_unsigned_t<Type>(orig_value);
-    if constexpr (varint_encoding::zig_zag == Encoding) {
-        value =
-            (value << 1) ^ (orig_value >> (sizeof(Type) * CHAR_BIT - 1));
+#if ZPP_BITS_HAS_BMI2
+    if (!std::is_constant_evaluated()) {
+        return _pdep_u64(value, 0x7f7f7f7f'7f7f7f7f);
     }
+#endif
+    value = (value & 0x00000000'0fffffff) |
+            ((value & 0x00ffffff'f0000000) << 4);
+    value = (value & 0x00003fff'00003fff) |
+            ((value & 0x0fffc000'0fffc000) << 2);
+    return (value & 0x007f007f'007f007f) |
+           ((value & 0x3f803f80'3f803f80) << 1);
+}
 
-    constexpr auto max_size = varint_max_size<Type>;
-    if constexpr (Archive::resizable) {
-        if (auto result = archive.enlarge_for(max_size); failure(result))
-            [[unlikely]] {
-            return result;
-        }
+// Gathers the low seven bits of each byte of a little endian word into a
+// value, undoing `varint_expand`.
+constexpr std::uint64_t varint_compact(std::uint64_t word)
+{
+#if ZPP_BITS_HAS_BMI2
+    if (!std::is_constant_evaluated()) {
+        return _pext_u64(word, 0x7f7f7f7f'7f7f7f7f);
     }
+#endif
+    word = (word & 0x007f007f'007f007f) |
+           ((word & 0x7f007f00'7f007f00) >> 1);
+    word = (word & 0x00003fff'00003fff) |
+           ((word & 0x3fff0000'3fff0000) >> 2);
+    return (word & 0x00000000'0fffffff) |
+           ((word & 0x0fffffff'00000000) >> 4);
+}
 
-    auto data = archive.remaining_data();
-    if constexpr (!Archive::resizable) {
-        auto data_size = data.size();
-        if (data_size < max_size) [[unlikely]] {
-            if (data_size < varint_size(value)) [[unlikely]] {
-                return errc{std::errc::result_out_of_range};
-            }
-        }
-    }
+// The room that `encode_varint_word` and `decode_varint_word` need, which
+// is a whole word even for shorter varints. The bytes past the varint are
+// read or written over as well, so the word at a time encoder is only used
+// where those bytes are scratch space, see `varint_word_stores`.
+template <typename Type>
+constexpr auto varint_word_room =
+    std::max(sizeof(std::uint64_t), varint_max_size<Type>);
 
-    using byte_type = std::remove_cvref_t<decltype(data[0])>;
-    std::size_t position = {};
-    while (value >= 0x80) {
-        data[position++] = byte_type((value & 0x7f) | 0x80);
-        value >>= (CHAR_BIT - 1);
+// Whether the view of `Archive` may ever have the room of
+// `varint_word_room`, which views of a smaller fixed size never do, so the
+// word at a time path is not even compiled for them.
+template <typename Archive, typename Type>
+constexpr auto varint_word_fits = [] {
+    using view_type = std::remove_cvref_t<typename Archive::view_type>;
+    if constexpr (requires {
+                      requires view_type::extent != std::dynamic_extent;
+                  }) {
+        return view_type::extent >= varint_word_room<Type>;
+    } else {
+        return true;
     }
-    data[position++] = byte_type(value);
+}();
 
-    archive.position() += position;
-    return errc{};
-}
+// Whether the output view of `Archive` may have room for
+// `varint_word_room` that it grew itself, so that storing a whole word there
+// does not overwrite bytes of the caller. A fixed view, such as a span, may
+// hold bytes of the caller past the position, which are left untouched. A
+// growing view only owns the room past its high water mark, see
+// `basic_out::owns_remaining_data`.
+template <typename Archive, typename Type>
+constexpr auto varint_word_stores =
+    Archive::resizable && varint_word_fits<Archive, Type>;
 
-constexpr auto decode_varint(auto data, auto & value, auto & position)
-{
-    using value_type = std::remove_cvref_t<decltype(value)>;
-    if (data.size() < varint_max_size<value_type>) [[unlikely]] {
-        std::size_t shift = 0;
-        for (auto & byte_value : data) {
-            auto next_byte = value_type(byte_value);
-            value |= (next_byte & 0x7f) << shift;
-            if (next_byte >= 0x80) [[unlikely]] {
-                shift += CHAR_BIT - 1;
-                continue;
-            }
+// Writes a varint with a single store of a little endian word, followed by
+// one or two more bytes for values of more than 56 bits, and returns its
+// size.
+template <typename Type>
+ZPP_BITS_INLINE inline std::size_t encode_varint_word(auto * data,
+                                                      Type value)
+{
+    using byte_type = std::remove_cvref_t<decltype(*data)>;
+    std::size_t size = varint_size(value);
+    auto word = varint_expand(value);
+    if constexpr (varint_max_size<Type> > sizeof(word)) {
+        if (size > sizeof(word)) [[unlikely]] {
+            word |= 0x80808080'80808080;
+            // Ignore GCC issue.
+#if !defined __clang__ && defined __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+#endif
+            std::memcpy(data, &word, sizeof(word));
+#if !defined __clang__ && defined __GNUC__
+#pragma GCC diagnostic pop
+#endif
+            data[sizeof(word)] = byte_type(
+                ((value >> 56) & 0x7f) | (size > sizeof(word) + 1 ? 0x80 : 0));
+            data[sizeof(word) + 1] = byte_type(value >> 63);
+            return size;
+        }
+    }
+    word |= 0x80808080'80808080 &
+            ((std::uint64_t{1} << (size - 1) * CHAR_BIT) - 1);
+    // Ignore GCC issue.
+#if !defined __clang__ && defined __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+#endif
+    std::memcpy(data, &word, sizeof(word));
+#if !defined __clang__ && defined __GNUC__
+#pragma GCC diagnostic pop
+#endif
+    return size;
+}
+
+// Reads a varint with a single load of a little endian word, finding its
+// end from the continuation bits of all of its bytes at once. The bytes of
+// the word past the varint are loaded but not used, and must be within the
+// input, which callers check against `varint_word_room`.
+template <typename Type>
+ZPP_BITS_INLINE inline errc decode_varint_word(const auto * data,
+                                               Type & value,
+                                               std::size_t & position)
+{
+    std::uint64_t word;
+    // Ignore GCC issue.
+#if !defined __clang__ && defined __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+    std::memcpy(&word, data, sizeof(word));
+#if !defined __clang__ && defined __GNUC__
+#pragma GCC diagnostic pop
+#endif
+    if (auto ends = ~word & 0x80808080'80808080) [[likely]] {
+        std::size_t size = std::countr_zero(ends) / CHAR_BIT + 1;
+        if constexpr (varint_max_size<Type> < sizeof(word)) {
+            if (size > varint_max_size<Type>) [[unlikely]] {
+                return std::errc::value_too_large;
+            }
+        }
+        value = Type(varint_compact(
+            word & (~std::uint64_t{} >> (sizeof(word) - size) * CHAR_BIT)));
+        position += size;
+        return {};
+    }
+
+    if constexpr (varint_max_size<Type> > sizeof(word)) {
+        auto next_byte = std::uint64_t(data[sizeof(word)]);
+        value = Type(varint_compact(word) | ((next_byte & 0x7f) << 56));
+        if (next_byte < 0x80) [[likely]] {
+            position += sizeof(word) + 1;
+            return {};
+        }
+        next_byte = std::uint64_t(data[sizeof(word) + 1]);
+        value |= Type((next_byte & 0x01) << 63);
+        if (next_byte < 0x80) [[likely]] {
+            position += sizeof(word) + 2;
+            return {};
+        }
+    }
+    return std::errc::value_too_large;
+}
+
+template <typename Archive, typename Type, varint_encoding Encoding>
+ZPP_BITS_INLINE constexpr auto serialize(
+    Archive & archive,
+    varint<Type, Encoding> self) requires(Archive::kind() == kind::out)
+{
+    auto orig_value = std::conditional_t<std::is_enum_v<Type>,
+                                         traits::underlying_type_t<Type>,
+                                         Type>(self.value);
+    auto value = std::make_unsigned_t<Type>(orig_value);
+    if constexpr (varint_encoding::zig_zag == Encoding) {
+        value =
+            (value << 1) ^ (orig_value >> (sizeof(Type) * CHAR_BIT - 1));
+    }
+
+    constexpr auto max_size = varint_max_size<Type>;
+    if constexpr (Archive::resizable) {
+        // Enlarge for the exact encoding size so that output of a
+        // precomputed size fits in place.
+        if (archive.remaining_data().size() < max_size) [[unlikely]] {
+            if (auto result = archive.enlarge_for(varint_size(value));
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+        }
+    }
+
+    auto data = archive.remaining_data();
+    if constexpr (!Archive::resizable && !Archive::prechecked) {
+        auto data_size = data.size();
+        if (data_size < max_size) [[unlikely]] {
+            if (data_size < varint_size(value)) [[unlikely]] {
+                return errc{std::errc::result_out_of_range};
+            }
+        }
+    }
+
+    if constexpr (std::endian::little == std::endian::native &&
+                  varint_word_stores<Archive, decltype(value)>) {
+        if (!std::is_constant_evaluated() &&
+            data.size() >= varint_word_room<decltype(value)> &&
+            archive.owns_remaining_data()) [[likely]] {
+            archive.position() += encode_varint_word(data.data(), value);
+            return errc{};
+        }
+    }
+
+    using byte_type = std::remove_cvref_t<decltype(data[0])>;
+    std::size_t position = {};
+    while (value >= 0x80) {
+        data[position++] = byte_type((value & 0x7f) | 0x80);
+        value >>= (CHAR_BIT - 1);
+    }
+    data[position++] = byte_type(value);
+
+    archive.position() += position;
+    return errc{};
+}
+
+template <bool WordFits = true>
+constexpr auto decode_varint(auto data, auto & value, auto & position)
+{
+    using value_type = std::remove_cvref_t<decltype(value)>;
+    if (data.size() < varint_max_size<value_type>) [[unlikely]] {
+        std::size_t shift = 0;
+        for (auto & byte_value : data) {
+            auto next_byte = value_type(byte_value);
+            value |= (next_byte & 0x7f) << shift;
+            if (next_byte >= 0x80) [[unlikely]] {
+                shift += CHAR_BIT - 1;
+                continue;
+            }
             position += 1 + std::distance(data.data(), &byte_value);
             return errc{};
         }
         return errc{std::errc::result_out_of_range};
     } else {
+        if constexpr (std::endian::little == std::endian::native &&
+                      WordFits) {
+            if (!std::is_constant_evaluated() &&
+                data.size() >= varint_word_room<value_type>) [[likely]] {
+                return decode_varint_word(data.data(), value, position);
+            }
+        }
+
         auto p = data.data();
         do {
             // clang-format off
@@ -1847,6 +2596,12 @@ ZPP_BITS_INLINE constexpr auto serialize(
         std::make_unsigned_t<traits::underlying_type_t<Type>>,
         std::make_unsigned_t<Type>>;
     value_type value{};
+    if constexpr (Archive::refillable) {
+        if (auto result = archive.refill(varint_max_size<value_type>);
+            failure(result)) [[unlikely]] {
+            return result;
+        }
+    }
     auto data = archive.remaining_data();
 
     if constexpr (!ZPP_BITS_INLINE_DECODE_VARINT) {
@@ -1857,7 +2612,8 @@ ZPP_BITS_INLINE constexpr auto serialize(
         } else if (auto result =
                        std::is_constant_evaluated()
                            ? decode_varint(data, value, position)
-                           : decode_varint(
+                           : decode_varint<
+                                 varint_word_fits<Archive, value_type>>(
                                  std::span{
                                      reinterpret_cast<const std::byte *>(
                                          data.data()),
@@ -1896,6 +2652,25 @@ ZPP_BITS_INLINE constexpr auto serialize(
         }
         return errc{std::errc::result_out_of_range};
     } else {
+        if constexpr (std::endian::little == std::endian::native &&
+                      varint_word_fits<Archive, value_type>) {
+            if (!std::is_constant_evaluated() &&
+                data.size() >= varint_word_room<value_type>) [[likely]] {
+                if (auto result = decode_varint_word(
+                        data.data(), value, archive.position());
+                    failure(result)) [[unlikely]] {
+                    return result;
+                }
+                if constexpr (varint_encoding::zig_zag == Encoding) {
+                    self.value =
+                        decltype(self.value)((value >> 1) ^ -(value & 0x1));
+                } else {
+                    self.value = decltype(self.value)(value);
+                }
+                return errc{};
+            }
+        }
+
         auto p = data.data();
         do {
             // clang-format off
@@ -1952,6 +2727,98 @@ struct size_varint : option<size_varint>
 };
 } // namespace options
 
+#if ZPP_BITS_HAS_X86_SHUFFLE
+// The byte shuffle that reverses each element of the given size, within
+// each 16 byte lane of a register of the given width.
+template <std::size_t Size, std::size_t Width>
+constexpr auto reverse_bytes_mask = [] {
+    std::array<char, Width> mask{};
+    for (std::size_t i = 0; i < Width; ++i) {
+        mask[i] = char(i % 16 - i % Size + Size - 1 - i % Size);
+    }
+    return mask;
+}();
+
+// Reverses the bytes of each element of the given size, a whole vector
+// register at a time, returning the number of elements that were left over.
+template <std::size_t Size>
+__attribute__((target("avx2"))) inline std::size_t
+reverse_bytes_avx2(std::byte * destination,
+                   const std::byte * source,
+                   std::size_t count)
+{
+    constexpr auto per_register = sizeof(__m256i) / Size;
+    const auto mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(
+        reverse_bytes_mask<Size, sizeof(__m256i)>.data()));
+
+    for (; count >= per_register; count -= per_register) {
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(destination),
+            _mm256_shuffle_epi8(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source)),
+                mask));
+        destination += sizeof(__m256i);
+        source += sizeof(__m256i);
+    }
+    return count;
+}
+
+template <std::size_t Size>
+__attribute__((target("ssse3"))) inline std::size_t
+reverse_bytes_ssse3(std::byte * destination,
+                    const std::byte * source,
+                    std::size_t count)
+{
+    constexpr auto per_register = sizeof(__m128i) / Size;
+    const auto mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+        reverse_bytes_mask<Size, sizeof(__m128i)>.data()));
+
+    for (; count >= per_register; count -= per_register) {
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(destination),
+            _mm_shuffle_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(source)),
+                mask));
+        destination += sizeof(__m128i);
+        source += sizeof(__m128i);
+    }
+    return count;
+}
+#endif
+
+// Copies count elements of the given size, reversing the bytes of each.
+// Source and destination may be the same, but must not otherwise overlap.
+template <std::size_t Size>
+inline void reverse_bytes(void * destination,
+                          const void * source,
+                          std::size_t count)
+{
+    auto to = static_cast<std::byte *>(destination);
+    auto from = static_cast<const std::byte *>(source);
+    auto left = count;
+
+#if ZPP_BITS_HAS_X86_SHUFFLE
+    static const auto has_avx2 = __builtin_cpu_supports("avx2");
+    static const auto has_ssse3 = __builtin_cpu_supports("ssse3");
+    if (has_avx2) {
+        left = reverse_bytes_avx2<Size>(to, from, left);
+    } else if (has_ssse3) {
+        left = reverse_bytes_ssse3<Size>(to, from, left);
+    }
+    to += (count - left) * Size;
+    from += (count - left) * Size;
+#endif
+
+    for (; left; --left) {
+        std::array<std::byte, Size> value;
+        std::memcpy(value.data(), from, Size);
+        std::reverse(value.begin(), value.end());
+        std::memcpy(to, value.data(), Size);
+        to += Size;
+        from += Size;
+    }
+}
+
 // Counts one level of nesting for the lifetime of the guard. Compiles away
 // entirely for archives that were not given a nesting limit.
 template <typename Archive>
@@ -1993,6 +2860,39 @@ private:
 template <typename Archive>
 nesting_guard(Archive &) -> nesting_guard<Archive>;
 
+// Keeps the bytes written from the point of construction in place for the
+// lifetime of the guard, so that they can still be written back to, even if
+// the archive view would otherwise hand them off to make room, or keep them
+// elsewhere. Compiles away entirely for archives over views that keep every
+// byte in place.
+template <typename Archive>
+struct pin_guard
+{
+    ZPP_BITS_INLINE constexpr explicit pin_guard(Archive & archive) :
+        m_archive(archive)
+    {
+        if constexpr (Archive::pinnable) {
+            ++archive.pin_count();
+        }
+    }
+
+    pin_guard(const pin_guard &) = delete;
+    pin_guard & operator=(const pin_guard &) = delete;
+
+    ZPP_BITS_INLINE constexpr ~pin_guard()
+    {
+        if constexpr (Archive::pinnable) {
+            --m_archive.pin_count();
+        }
+    }
+
+private:
+    Archive & m_archive;
+};
+
+template <typename Archive>
+pin_guard(Archive &) -> pin_guard<Archive>;
+
 template <concepts::byte_view ByteView, typename... Options>
 class basic_out
 {
@@ -2038,15 +2938,60 @@ public:
 
     constexpr static auto enlarger = traits::enlarger<Options...>();
 
+    constexpr static auto alignment = traits::alignment<Options...>();
+
     constexpr static auto no_enlarge_overflow =
         (... ||
          std::same_as<std::remove_cvref_t<Options>, options::no_enlarge_overflow>);
 
+    constexpr static auto prechecked =
+        (... ||
+         std::same_as<std::remove_cvref_t<Options>, traits::prechecked_bounds>);
+
     constexpr static bool resizable = requires(ByteView view)
     {
         view.resize(1);
     };
 
+    // A view that hands the bytes written to it off elsewhere when it runs
+    // out of room, instead of growing to hold the entire output.
+    constexpr static bool flushable =
+        resizable &&
+        requires(ByteView view,
+                 std::size_t & position,
+                 std::span<const byte_type> bytes)
+    {
+        {view.flush(position)} -> std::same_as<errc>;
+        {view.write(position, bytes)} -> std::same_as<errc>;
+    };
+
+    // A view that may keep a reference to a large payload instead of a
+    // copy of it, following the bytes written to it so far.
+    constexpr static bool gathering =
+        resizable &&
+        requires(ByteView view,
+                 std::size_t position,
+                 std::span<const byte_type> bytes)
+    {
+        {view.reference(position, bytes)} -> std::same_as<bool>;
+    };
+
+    constexpr static bool pinnable = flushable || gathering;
+
+    // A view that only counts the bytes written to it, so that neither
+    // their content nor writing back into them matters.
+    constexpr static bool counting =
+        flushable && requires(ByteView view, std::size_t & position)
+    {
+        view.count(position, std::size_t{});
+    };
+
+    // A view that may fail to resize, such as a file, and says so.
+    constexpr static bool fallible_resize = requires(ByteView view)
+    {
+        {view.resize(1)} -> std::same_as<errc>;
+    };
+
     using view_type =
         std::conditional_t<resizable,
                            ByteView &,
@@ -2061,12 +3006,26 @@ public:
 
     constexpr explicit basic_out(ByteView & view, Options && ... options) : m_data(view)
     {
+        if constexpr (resizable) {
+            // The bytes that the view already holds are of the caller.
+            m_high_water = m_data.size();
+        }
         (options(*this), ...);
     }
 
+private:
+    // The options of the archive that this one writes for were already
+    // applied to its view, so they are not applied again.
+    constexpr basic_out(traits::prechecked_bounds, ByteView && view) :
+        m_data(view)
+    {
+    }
+
+public:
+
     ZPP_BITS_INLINE constexpr auto operator()(auto &&... items)
     {
-        return serialize_many(items...);
+        return serialize_bounded(items...);
     }
 
     constexpr decltype(auto) data()
@@ -2081,6 +3040,8 @@ public:
 
     constexpr std::size_t & position()
     {
+        // The position may be moved back through the reference.
+        raise_high_water();
         return m_position;
     }
 
@@ -2090,9 +3051,26 @@ public:
                                     m_data.size() - m_position};
     }
 
+    // Whether the bytes past the position are room that the archive grew
+    // itself and did not write yet, rather than bytes that the view held
+    // before, or bytes that were written before moving the position back,
+    // so that they may be written over freely.
+    constexpr bool owns_remaining_data() const
+    {
+        if constexpr (resizable) {
+            return m_position >= m_high_water;
+        } else {
+            return false;
+        }
+    }
+
     constexpr auto processed_data()
     {
-        return std::span<byte_type>{m_data.data(), m_position};
+        if constexpr (requires { m_data.processed_data(m_position); }) {
+            return m_data.processed_data(m_position);
+        } else {
+            return std::span<byte_type>{m_data.data(), m_position};
+        }
     }
 
     constexpr auto & nesting_depth()
@@ -2100,8 +3078,14 @@ public:
         return m_nesting;
     }
 
+    constexpr auto & pin_count()
+    {
+        return m_pins;
+    }
+
     constexpr void reset(std::size_t position = 0)
     {
+        raise_high_water();
         m_position = position;
     }
 
@@ -2110,10 +3094,32 @@ public:
         return kind::out;
     }
 
+    // Hands the bytes written so far off from a flushable view, making
+    // room from the beginning of the view again.
+    constexpr errc flush() requires flushable
+    {
+        auto result = m_data.flush(m_position);
+        lower_high_water();
+        return result;
+    }
+
     ZPP_BITS_INLINE constexpr errc enlarge_for(auto additional_size)
     {
         auto size = m_data.size();
         if (additional_size > size - m_position) [[unlikely]] {
+            if constexpr (flushable) {
+                if (!m_pins) {
+                    if (auto result = flush(); failure(result))
+                        [[unlikely]] {
+                        return result;
+                    }
+                    size = m_data.size();
+                    if (additional_size <= size - m_position) {
+                        return {};
+                    }
+                }
+            }
+
             constexpr auto multiplier = std::get<0>(enlarger);
             constexpr auto divisor = std::get<1>(enlarger);
             static_assert(multiplier != 0 && divisor != 0);
@@ -2137,73 +3143,321 @@ public:
             if constexpr (divisor != 1) {
                 new_size /= divisor;
             }
+            if constexpr (requires { m_data.capacity(); }) {
+                // Rather than growing past capacity that was reserved in
+                // advance, use it up first.
+                if (auto capacity = m_data.capacity();
+                    new_size > capacity &&
+                    additional_size <= capacity - m_position) {
+                    new_size = capacity;
+                }
+            }
             if constexpr (allocation_limit !=
                           std::numeric_limits<std::size_t>::max()) {
                 if (new_size > allocation_limit) [[unlikely]] {
                     return std::errc::no_buffer_space;
                 }
             }
-            m_data.resize(new_size);
+            if constexpr (fallible_resize) {
+                return m_data.resize(new_size);
+            } else if constexpr (requires {
+                                     m_data.resize_and_overwrite(
+                                         new_size, [](auto, auto size) {
+                                             return size;
+                                         });
+                                 }) {
+                // The grown bytes are about to be overwritten, so they are
+                // left uninitialized.
+                m_data.resize_and_overwrite(
+                    new_size, [](auto, auto size) { return size; });
+            } else {
+                m_data.resize(new_size);
+            }
         }
         return {};
     }
 
 protected:
-    ZPP_BITS_INLINE constexpr errc serialize_many(auto && first_item,
-                                                  auto &&... items)
+    // Keeps the bytes up to the position from being written over as room,
+    // before the position moves back.
+    ZPP_BITS_INLINE constexpr void raise_high_water()
     {
-        if (auto result = serialize_one(first_item); failure(result))
-            [[unlikely]] {
-            return result;
+        if constexpr (resizable) {
+            m_high_water = std::max(m_high_water, m_position);
         }
-
-        return serialize_many(items...);
     }
 
-    ZPP_BITS_INLINE constexpr errc serialize_many()
+    // After a flushable view rebased the position, the bytes before it
+    // were handed off, and what follows is room again.
+    ZPP_BITS_INLINE constexpr void lower_high_water()
     {
-        return {};
+        if constexpr (resizable) {
+            m_high_water = m_position;
+        }
     }
 
-    constexpr auto option(append)
+    // Items of bounded size that all fit into the room that is left are
+    // serialized without checking the room again field by field.
+    ZPP_BITS_INLINE constexpr errc serialize_bounded(auto &&... items)
     {
-        static_assert(resizable);
-        m_position = m_data.size();
+        if constexpr (!resizable && !prechecked && alignment == 1 &&
+                      sizeof...(items) &&
+                      (... && concepts::bounded_serialized_size<
+                                  decltype(items)>)) {
+            constexpr auto max_size =
+                (0 + ... +
+                 max_serialized_size_v<std::remove_cvref_t<decltype(items)>>);
+            if (max_size <= m_data.size() - m_position) [[likely]] {
+                auto out = prechecked_out();
+                auto result = out.serialize_many(items...);
+                m_position += out.position();
+                return result;
+            }
+        }
+        return serialize_many(items...);
     }
 
-    constexpr auto option(reserve size)
-    {
-        static_assert(resizable);
-        m_data.reserve(size.size);
-    }
+    // Writes a run of varints, each with a single store of a whole word
+    // while there is room for one, into room that the archive grew itself,
+    // see `owns_remaining_data`.
+    constexpr errc write_varints(auto items)
+    {
+        using type = typename decltype(items)::value_type;
+        constexpr auto encoding = type::encoding;
+        using value_type = std::make_unsigned_t<std::conditional_t<
+            std::is_enum_v<typename type::value_type>,
+            traits::underlying_type_t<typename type::value_type>,
+            typename type::value_type>>;
+
+        auto encode = [](auto item) {
+            auto value = value_type(item.value);
+            if constexpr (varint_encoding::zig_zag == encoding) {
+                value = value_type(
+                    (value << 1) ^
+                    value_type(std::make_signed_t<value_type>(value) >>
+                               (sizeof(value) * CHAR_BIT - 1)));
+            }
+            return value;
+        };
 
-    constexpr auto option(resize size)
-    {
-        static_assert(resizable);
-        m_data.resize(size.size);
-        if (m_position > size.size) {
-            m_position = size.size;
+        if constexpr (resizable && !flushable) {
+            // One enlargement for the whole run.
+            std::size_t size{};
+            for (auto item : items) {
+                size += varint_size(encode(item));
+            }
+            if (auto result = enlarge_for(size); failure(result))
+                [[unlikely]] {
+                return result;
+            }
         }
+
+        std::size_t index{};
+        if constexpr (std::endian::little == std::endian::native &&
+                      varint_word_stores<basic_out, value_type>) {
+            if (!std::is_constant_evaluated() && owns_remaining_data()) {
+                // Kept in locals, as the bytes written could otherwise
+                // alias them.
+                auto data = m_data.data();
+                auto room = m_data.size();
+                auto position = m_position;
+                for (; index < items.size() &&
+                       room - position >= varint_word_room<value_type>;
+                     ++index) {
+                    position += encode_varint_word(data + position,
+                                                   encode(items[index]));
+                }
+                m_position = position;
+            }
+        }
+
+        for (; index < items.size(); ++index) {
+            if (auto result = serialize_one(items[index]); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+        }
+        return {};
     }
 
-    ZPP_BITS_INLINE constexpr errc serialize_one(concepts::unspecialized auto && item)
+    // Pads with zero bytes up to the alignment of `Type`, or the alignment
+    // of the archive if smaller, counting from the beginning of the output.
+    template <typename Type>
+    ZPP_BITS_INLINE constexpr errc align_for()
     {
-        using type = std::remove_cvref_t<decltype(item)>;
-        static_assert(!std::is_pointer_v<type>);
+        constexpr auto align = std::min(alignof(Type), alignment);
+        if constexpr (align > 1) {
+            // Chunks rebase the position without saying how far.
+            static_assert(!pinnable || requires(ByteView view) {
+                view.flushed();
+            });
 
-        if constexpr (requires { type::serialize(*this, item); }) {
+            auto offset = m_position;
+            if constexpr (flushable) {
+                offset += m_data.flushed();
+            }
+
+            auto padding = (align - offset % align) % align;
+            if (!padding) {
+                return {};
+            }
+
+            if constexpr (resizable) {
+                if (auto result = enlarge_for(padding); failure(result))
+                    [[unlikely]] {
+                    return result;
+                }
+            } else if (padding > m_data.size() - m_position) [[unlikely]] {
+                return std::errc::result_out_of_range;
+            }
+
+            std::fill_n(m_data.data() + m_position, padding, byte_type{});
+            m_position += padding;
+        }
+        return {};
+    }
+
+    // Writes into the room that is left without checking it, for items
+    // that the room was already checked or enlarged for, with the same
+    // options as this archive.
+    constexpr auto prechecked_out()
+    {
+        return basic_out<std::span<byte_type>,
+                         std::remove_cvref_t<Options>...,
+                         traits::prechecked_bounds>{
+            traits::prechecked_bounds{}, remaining_data()};
+    }
+
+    // Items that are written as a fixed number of bytes, with no branches.
+    template <typename Type>
+    constexpr static bool fixed_size()
+    {
+        if constexpr (concepts::has_serialize<Type>) {
+            return false;
+        } else if constexpr (std::is_fundamental_v<Type> ||
+                             std::is_enum_v<Type>) {
+            return true;
+        } else if constexpr (!std::is_class_v<Type> ||
+                             !concepts::unspecialized<Type> ||
+                             concepts::empty<Type>) {
+            return false;
+        } else {
+            return concepts::serialize_as_bytes<basic_out, Type>;
+        }
+    }
+
+    // The number of leading fixed size items, and their total size.
+    template <typename... Types>
+    constexpr static auto fixed_size_run()
+    {
+        constexpr bool fixed[] = {fixed_size<std::remove_cvref_t<Types>>()...};
+        constexpr std::size_t sizes[] = {sizeof(std::remove_cvref_t<Types>)...};
+        std::size_t count = 0;
+        std::size_t size = 0;
+        while (count < sizeof...(Types) && fixed[count]) {
+            size += sizes[count++];
+        }
+        return std::pair{count, size};
+    }
+
+    ZPP_BITS_INLINE constexpr errc serialize_many(auto && first_item,
+                                                  auto &&... items)
+    {
+        if constexpr (!prechecked && alignment == 1) {
+            constexpr auto run =
+                fixed_size_run<decltype(first_item), decltype(items)...>();
+            if constexpr (run.first > 1) {
+                return serialize_run<run.second>(
+                    std::make_index_sequence<run.first>(),
+                    std::make_index_sequence<sizeof...(items) + 1 -
+                                             run.first>(),
+                    std::forward_as_tuple(first_item, items...));
+            }
+        }
+
+        if (auto result = serialize_one(first_item); failure(result))
+            [[unlikely]] {
+            return result;
+        }
+
+        return serialize_many(items...);
+    }
+
+    // A run of fixed size items takes a single check, or enlargement, and
+    // a single position update, then straight line stores.
+    template <std::size_t Size, std::size_t... Indices, std::size_t... Rest>
+    ZPP_BITS_INLINE constexpr errc serialize_run(std::index_sequence<Indices...>,
+                                                 std::index_sequence<Rest...>,
+                                                 auto && items)
+    {
+        if constexpr (resizable) {
+            if (auto result = enlarge_for(Size); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+        } else if (Size > m_data.size() - m_position) [[unlikely]] {
+            return std::errc::result_out_of_range;
+        }
+
+        auto out = prechecked_out();
+        (..., (void)out.serialize_one(std::get<Indices>(items)));
+        m_position += Size;
+
+        return serialize_many(
+            std::get<sizeof...(Indices) + Rest>(items)...);
+    }
+
+    ZPP_BITS_INLINE constexpr errc serialize_many()
+    {
+        return {};
+    }
+
+    constexpr auto option(append)
+    {
+        static_assert(resizable);
+        m_position = m_data.size();
+    }
+
+    constexpr auto option(reserve size)
+    {
+        static_assert(resizable);
+        m_data.reserve(size.size);
+    }
+
+    constexpr auto option(resize size)
+    {
+        static_assert(resizable);
+        m_data.resize(size.size);
+        if (m_position > size.size) {
+            m_position = size.size;
+        }
+    }
+
+    ZPP_BITS_INLINE constexpr errc serialize_one(concepts::unspecialized auto && item)
+    {
+        using type = std::remove_cvref_t<decltype(item)>;
+        static_assert(!std::is_pointer_v<type>);
+
+        if constexpr (requires { type::serialize(*this, item); }) {
             return type::serialize(*this, item);
         } else if constexpr (requires { serialize(*this, item); }) {
             return serialize(*this, item);
         } else if constexpr (std::is_fundamental_v<type> || std::is_enum_v<type>) {
+            if (auto result = align_for<type>(); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+
             if constexpr (resizable) {
                 if (auto result = enlarge_for(sizeof(item));
                     failure(result)) [[unlikely]] {
                     return result;
                 }
-            } else if (sizeof(item) > m_data.size() - m_position)
-                [[unlikely]] {
-                return std::errc::result_out_of_range;
+            } else if constexpr (!prechecked) {
+                if (sizeof(item) > m_data.size() - m_position)
+                    [[unlikely]] {
+                    return std::errc::result_out_of_range;
+                }
             }
 
             if (std::is_constant_evaluated()) {
@@ -2236,9 +3490,16 @@ protected:
                                      bytes<typename type::value_type>,
                                      type>;
                              }) {
+            // Numbers of the other byte order are reversed as they are
+            // copied, so they are never handed off in place.
+            constexpr auto swapped =
+                endian_aware &&
+                !concepts::byte_type<
+                    std::remove_cvref_t<decltype(*item.data())>>;
             static_assert(
-                !endian_aware ||
-                concepts::byte_type<
+                !swapped ||
+                concepts::serialize_as_swapped_bytes<
+                    basic_out,
                     std::remove_cvref_t<decltype(*item.data())>>);
 
             auto item_size_in_bytes = item.size_in_bytes();
@@ -2246,14 +3507,50 @@ protected:
                 return {};
             }
 
+            if (auto result = align_for<typename type::value_type>();
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+
+            if constexpr (counting) {
+                // Only the size of the payload matters.
+                m_data.count(m_position, item_size_in_bytes);
+                lower_high_water();
+                return {};
+            } else if constexpr (flushable && !swapped) {
+                // The view knows best where to put a payload that does not
+                // fit the room that is left.
+                if (!std::is_constant_evaluated() && !m_pins &&
+                    item_size_in_bytes > m_data.size() - m_position) {
+                    auto result = m_data.write(
+                        m_position,
+                        std::span<const byte_type>{
+                            reinterpret_cast<const byte_type *>(item.data()),
+                            item_size_in_bytes});
+                    lower_high_water();
+                    return result;
+                }
+            } else if constexpr (gathering && !swapped) {
+                if (!std::is_constant_evaluated() && !m_pins &&
+                    m_data.reference(
+                        m_position,
+                        std::span<const byte_type>{
+                            reinterpret_cast<const byte_type *>(item.data()),
+                            item_size_in_bytes})) {
+                    return {};
+                }
+            }
+
             if constexpr (resizable) {
                 if (auto result = enlarge_for(item_size_in_bytes);
                     failure(result)) [[unlikely]] {
                     return result;
                 }
-            } else if (item_size_in_bytes > m_data.size() - m_position)
-                [[unlikely]] {
-                return std::errc::result_out_of_range;
+            } else if constexpr (!prechecked) {
+                if (item_size_in_bytes > m_data.size() - m_position)
+                    [[unlikely]] {
+                    return std::errc::result_out_of_range;
+                }
             }
 
             if (std::is_constant_evaluated()) {
@@ -2268,7 +3565,8 @@ protected:
                          ++i) {
                         m_data[m_position +
                                index * sizeof(typename type::value_type) +
-                               i] = value[i];
+                               i] =
+                            value[swapped ? sizeof(value) - 1 - i : i];
                     }
                 }
             } else {
@@ -2278,9 +3576,14 @@ protected:
 #pragma GCC diagnostic ignored "-Warray-bounds"
 #pragma GCC diagnostic ignored "-Wstringop-overflow"
 #endif
-                std::memcpy(m_data.data() + m_position,
-                            item.data(),
-                            item_size_in_bytes);
+                if constexpr (swapped) {
+                    reverse_bytes<sizeof(typename type::value_type)>(
+                        m_data.data() + m_position, item.data(), item.count());
+                } else {
+                    std::memcpy(m_data.data() + m_position,
+                                item.data(),
+                                item_size_in_bytes);
+                }
 #if !defined __clang__ && defined __GNUC__
 #pragma GCC diagnostic pop
 #endif
@@ -2323,8 +3626,12 @@ protected:
         using value_type = std::remove_cvref_t<decltype(array[0])>;
 
         if constexpr (concepts::serialize_as_bytes<decltype(*this),
-                                                   value_type>) {
+                                                   value_type> ||
+                      concepts::serialize_as_swapped_bytes<decltype(*this),
+                                                           value_type>) {
             return serialize_one(bytes(array));
+        } else if constexpr (concepts::varint<value_type>) {
+            return write_varints(std::span{array});
         } else {
             for (auto & item : array) {
                 if (auto result = serialize_one(item); failure(result))
@@ -2343,8 +3650,10 @@ protected:
         using type = std::remove_cvref_t<decltype(container)>;
         using value_type = typename type::value_type;
 
-        if constexpr (concepts::serialize_as_bytes<decltype(*this),
-                                                   value_type> &&
+        if constexpr ((concepts::serialize_as_bytes<decltype(*this),
+                                                    value_type> ||
+                       concepts::serialize_as_swapped_bytes<decltype(*this),
+                                                            value_type>) &&
                       std::is_base_of_v<std::random_access_iterator_tag,
                                         typename std::iterator_traits<
                                             typename type::iterator>::
@@ -2397,6 +3706,13 @@ protected:
                     return result;
                 }
             }
+            if constexpr (concepts::varint<value_type> &&
+                          std::contiguous_iterator<
+                              decltype(container.begin())>) {
+                return write_varints(
+                    std::span{std::to_address(container.begin()),
+                              container.size()});
+            }
             for (auto & item : container) {
                 if (auto result = serialize_one(item); failure(result))
                     [[unlikely]] {
@@ -2407,6 +3723,39 @@ protected:
         }
     }
 
+    template <typename SizeType = default_size_type>
+    ZPP_BITS_INLINE constexpr errc
+    serialize_one(concepts::flat_map auto && container)
+    {
+        // The keys follow the size, then the mapped values, each in a
+        // block of its own.
+        if constexpr (!std::is_void_v<SizeType>) {
+            if (auto result =
+                    serialize_one(static_cast<SizeType>(container.size()));
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+        }
+
+        if (auto result = serialize_one<void>(container.keys());
+            failure(result)) [[unlikely]] {
+            return result;
+        }
+        return serialize_one<void>(container.values());
+    }
+
+    template <typename SizeType = default_size_type>
+    ZPP_BITS_INLINE constexpr errc
+    serialize_one(concepts::flat_set auto && container) requires
+        std::contiguous_iterator<
+            typename std::remove_cvref_t<decltype(container)>::iterator>
+    {
+        using value_type =
+            typename std::remove_cvref_t<decltype(container)>::value_type;
+        return serialize_one<SizeType>(std::span<const value_type>{
+            std::to_address(container.begin()), container.size()});
+    }
+
     ZPP_BITS_INLINE constexpr errc
     serialize_one(concepts::tuple auto && tuple)
     {
@@ -2497,22 +3846,85 @@ protected:
                 failure(result)) [[unlikely]] {
                 return result;
             }
-        } else if (size_in_bytes > m_data.size() - m_position)
-            [[unlikely]] {
-            return std::errc::result_out_of_range;
+        } else if constexpr (!prechecked) {
+            if (size_in_bytes > m_data.size() - m_position)
+                [[unlikely]] {
+                return std::errc::result_out_of_range;
+            }
         }
 
         auto data = m_data.data() + m_position;
-        for (std::size_t i = 0; i < size; ++i) {
-            auto & value = data[i / CHAR_BIT];
-            value = byte_type(static_cast<unsigned char>(value) |
-                              (bitset[i] << (i & 0x7)));
+        if constexpr (size <= std::numeric_limits<unsigned long long>::digits) {
+            auto word = bitset.to_ullong();
+            for (std::size_t i = 0; i < size_in_bytes; ++i) {
+                data[i] = byte_type(
+                    static_cast<unsigned char>(word >> (i * CHAR_BIT)));
+            }
+        } else {
+            pack_bits(data, size, bitset);
+        }
+
+        m_position += size_in_bytes;
+        return {};
+    }
+
+    template <typename SizeType = default_size_type>
+    ZPP_BITS_INLINE constexpr errc
+    serialize_one(concepts::bit_container auto && container)
+    {
+        auto size = container.size();
+        if constexpr (!std::is_void_v<SizeType>) {
+            if (auto result = serialize_one(static_cast<SizeType>(size));
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+        }
+
+        auto size_in_bytes = (size + (CHAR_BIT - 1)) / CHAR_BIT;
+        if constexpr (resizable) {
+            if (auto result = enlarge_for(size_in_bytes);
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+        } else if constexpr (!prechecked) {
+            if (size_in_bytes > m_data.size() - m_position)
+                [[unlikely]] {
+                return std::errc::result_out_of_range;
+            }
         }
 
+        pack_bits(m_data.data() + m_position, size, container);
         m_position += size_in_bytes;
         return {};
     }
 
+    // Packs `size` bits, eight to a byte, starting from the least
+    // significant bit of the first byte. Every byte is written in whole,
+    // since it may hold anything, such as memory that was grown without
+    // initialization.
+    ZPP_BITS_INLINE constexpr static void
+    pack_bits(auto data, std::size_t size, auto && bits)
+    {
+        auto whole_bytes = size / CHAR_BIT;
+        for (std::size_t i = 0; i < whole_bytes; ++i) {
+            unsigned char value{};
+            for (std::size_t bit = 0; bit < CHAR_BIT; ++bit) {
+                value |= static_cast<unsigned char>(
+                    bool(bits[i * CHAR_BIT + bit]) << bit);
+            }
+            data[i] = byte_type(value);
+        }
+
+        if (auto left = size % CHAR_BIT) {
+            unsigned char value{};
+            for (std::size_t bit = 0; bit < left; ++bit) {
+                value |= static_cast<unsigned char>(
+                    bool(bits[whole_bytes * CHAR_BIT + bit]) << bit);
+            }
+            data[whole_bytes] = byte_type(value);
+        }
+    }
+
     template <typename SizeType = default_size_type>
     ZPP_BITS_INLINE constexpr errc serialize_one(concepts::by_protocol auto && item)
     {
@@ -2524,7 +3936,41 @@ protected:
             return guard.result;
         }
 
-        if constexpr (!std::is_void_v<SizeType>) {
+        if constexpr (!std::is_void_v<SizeType> && counting) {
+            // Nothing is written back, only the size of the size counts.
+            auto size_position = m_position + m_data.flushed();
+            if (auto result = serialize_one(SizeType{});
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+
+            if constexpr (requires { typename type::serialize; }) {
+                constexpr auto protocol = type::serialize::value;
+                if (auto result = protocol(*this, item); failure(result))
+                    [[unlikely]] {
+                    return result;
+                }
+            } else {
+                constexpr auto protocol = decltype(serialize(item))::value;
+                if (auto result = protocol(*this, item); failure(result))
+                    [[unlikely]] {
+                    return result;
+                }
+            }
+
+            if constexpr (concepts::varint<SizeType>) {
+                constexpr auto preserialized_varint_size = 1;
+                auto message_size = m_position + m_data.flushed() -
+                                    size_position - preserialized_varint_size;
+                m_data.count(m_position,
+                             varint_size(message_size) -
+                                 preserialized_varint_size);
+                lower_high_water();
+            }
+            return {};
+        } else if constexpr (!std::is_void_v<SizeType>) {
+            // The size is written back at the end.
+            pin_guard pin{*this};
             auto size_position = m_position;
             if (auto result = serialize_one(SizeType{});
                 failure(result)) [[unlikely]] {
@@ -2603,6 +4049,15 @@ protected:
     std::size_t m_position{};
     [[no_unique_address]] traits::nesting_depth_t<nesting_depth_limit>
         m_nesting{};
+    [[no_unique_address]] std::
+        conditional_t<pinnable, std::size_t, traits::no_pin_count>
+            m_pins{};
+    // The end of the bytes that are not room of the archive, which are
+    // those the view held before and those written so far, as of the last
+    // time the position could move back.
+    [[no_unique_address]] std::
+        conditional_t<resizable, std::size_t, traits::no_high_water>
+            m_high_water{};
 };
 
 template <concepts::byte_view ByteView = std::vector<std::byte>, typename... Options>
@@ -2618,6 +4073,7 @@ public:
     friend access;
 
     using base::resizable;
+    using base::flushable;
     using base::enlarger;
 
     constexpr static auto no_fit_size =
@@ -2626,16 +4082,29 @@ public:
 
     ZPP_BITS_INLINE constexpr auto operator()(auto &&... items)
     {
-        if constexpr (resizable && !no_fit_size &&
+        if constexpr (flushable && !no_fit_size) {
+            if (auto result = serialize_many(items...); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+            return base::flush();
+        } else if constexpr (resizable && !no_fit_size &&
                       enlarger != std::tuple{1, 1}) {
             auto end = m_data.size();
             auto result = serialize_many(items...);
             if (m_position >= end) {
-                m_data.resize(m_position);
+                if constexpr (base::fallible_resize) {
+                    if (auto fitted = m_data.resize(m_position);
+                        failure(fitted) && !failure(result)) [[unlikely]] {
+                        return fitted;
+                    }
+                } else {
+                    m_data.resize(m_position);
+                }
             }
             return result;
         } else {
-            return serialize_many(items...);
+            return base::serialize_bounded(items...);
         }
     }
 
@@ -2666,6 +4135,55 @@ out(const sized_item<Type, SizeType> &, Options &&...)
 template <typename Type, typename SizeType, typename... Options>
 out(sized_item<Type, SizeType> &&, Options &&...) -> out<Type, Options...>;
 
+// A view of another view up to `size` bytes, that reads the data of the
+// other view every time, so that it follows it if its storage moves, such
+// as a vector that grows while it is being read.
+template <typename View>
+class bounded_view
+{
+public:
+    using value_type = typename View::value_type;
+
+    constexpr bounded_view(View & view, std::size_t size) :
+        m_view(view), m_size(size)
+    {
+    }
+
+    constexpr auto data() const
+    {
+        return std::data(m_view);
+    }
+
+    constexpr std::size_t size() const
+    {
+        return m_size;
+    }
+
+    constexpr auto begin() const
+    {
+        return data();
+    }
+
+    constexpr auto end() const
+    {
+        return data() + m_size;
+    }
+
+    constexpr decltype(auto) operator[](std::size_t index) const
+    {
+        return data()[index];
+    }
+
+    constexpr View & underlying() const
+    {
+        return m_view;
+    }
+
+private:
+    View & m_view;
+    std::size_t m_size;
+};
+
 template <concepts::byte_view ByteView = std::vector<std::byte>,
           typename... Options>
 class in
@@ -2674,6 +4192,9 @@ public:
     template <typename... Types>
     using template_type = in<Types...>;
 
+    template <concepts::byte_view, typename...>
+    friend class in;
+
     template <typename>
     friend struct option;
 
@@ -2708,9 +4229,22 @@ public:
     constexpr static auto nesting_limited =
         nesting_depth_limit != std::numeric_limits<std::size_t>::max();
 
+    constexpr static auto has_memory_resource =
+        (... ||
+         std::same_as<std::remove_cvref_t<Options>, memory_resource>);
+
+    constexpr static auto copies_misaligned =
+        (... ||
+         std::same_as<std::remove_cvref_t<Options>, copy_misaligned>);
+
+    static_assert(!copies_misaligned || has_memory_resource,
+                  "copy_misaligned requires a memory_resource to copy into.");
+
+    constexpr static auto alignment = traits::alignment<Options...>();
+
     constexpr explicit in(ByteView && view, Options && ... options) : m_data(view)
     {
-        static_assert(!resizable);
+        static_assert(!resizable && !refillable);
         (options(*this), ...);
     }
 
@@ -2719,6 +4253,19 @@ public:
         (options(*this), ...);
     }
 
+private:
+    // The options of `archive` were already applied, so they are not
+    // applied again, and their state is taken from it.
+    template <typename OtherView>
+    constexpr in(in<OtherView, Options...> & archive, ByteView && view) :
+        m_data(view),
+        m_nesting(archive.m_nesting),
+        m_memory_resource(archive.m_memory_resource)
+    {
+    }
+
+public:
+
     ZPP_BITS_INLINE constexpr auto operator()(auto &&... items)
     {
         return serialize_many(items...);
@@ -2750,6 +4297,26 @@ public:
         return std::span<byte_type>{m_data.data(), m_position};
     }
 
+    // An archive with the options of this one, that reads the next `size`
+    // bytes of the input and cannot read past them. It shares the positions
+    // of this archive, starting at the current one, and follows the input
+    // if its storage moves. The position of this archive is left as is.
+    constexpr auto frame(std::size_t size)
+    {
+        using frame_type =
+            in<bounded_view<std::remove_reference_t<view_type>>, Options...>;
+        if (size > m_data.size() - m_position) [[unlikely]] {
+            return value_or_errc<frame_type>{
+                errc{std::errc::result_out_of_range}};
+        }
+
+        frame_type frame{*this,
+                         bounded_view<std::remove_reference_t<view_type>>{
+                             m_data, m_position + size}};
+        frame.m_position = m_position;
+        return value_or_errc<frame_type>{std::move(frame)};
+    }
+
     constexpr void reset(std::size_t position = 0)
     {
         m_position = position;
@@ -2760,7 +4327,42 @@ public:
         return m_nesting;
     }
 
-    constexpr static auto kind()
+    constexpr auto resource() const requires has_memory_resource
+    {
+        return m_memory_resource;
+    }
+
+    // Switches a container with a polymorphic allocator over to the memory
+    // resource of the archive, which drops what the container held.
+    constexpr void use_memory_resource(auto & container)
+    {
+        using type = std::remove_cvref_t<decltype(container)>;
+
+        if constexpr (has_memory_resource && requires {
+                          container.get_allocator().resource();
+                          type(typename type::allocator_type{});
+                      }) {
+            if (container.get_allocator().resource() != m_memory_resource) {
+                // Keeps the comparator or the hasher of the container.
+                auto replacement = [&] {
+                    typename type::allocator_type allocator{
+                        m_memory_resource};
+                    if constexpr (requires {
+                                      empty_like(container, allocator);
+                                  }) {
+                        return empty_like(container, allocator);
+                    } else {
+                        return type(allocator);
+                    }
+                }();
+                std::destroy_at(std::addressof(container));
+                std::construct_at(std::addressof(container),
+                                  std::move(replacement));
+            }
+        }
+    }
+
+    constexpr static auto kind()
     {
         return kind::in;
     }
@@ -2770,13 +4372,222 @@ public:
         view.resize(1);
     };
 
-    using view_type =
-        std::conditional_t<resizable,
-                           ByteView &,
-                           std::remove_cvref_t<decltype(
-                               std::span{std::declval<ByteView &>()})>>;
+    // A view that is a window over a larger input, which moves forward
+    // on demand, rather than the entire input.
+    constexpr static bool refillable =
+        requires(ByteView view,
+                 std::size_t & position,
+                 std::span<std::remove_const_t<byte_type>> bytes)
+    {
+        {view.refill(position, std::size_t{})} -> std::same_as<errc>;
+        {view.read(position, bytes)} -> std::same_as<errc>;
+    };
+
+    // Makes at least `size` more bytes available in the view, failing if
+    // the input ends before that.
+    ZPP_BITS_INLINE constexpr errc fill_for(std::size_t size)
+    {
+        if (size > m_data.size() - m_position) [[unlikely]] {
+            if constexpr (refillable) {
+                if constexpr (allocation_limit !=
+                              std::numeric_limits<std::size_t>::max()) {
+                    if (size > allocation_limit) [[unlikely]] {
+                        return std::errc::message_size;
+                    }
+                }
+                if (auto result = m_data.refill(m_position, size);
+                    failure(result)) [[unlikely]] {
+                    return result;
+                }
+                if (size <= m_data.size() - m_position) {
+                    return {};
+                }
+            }
+            return std::errc::result_out_of_range;
+        }
+        return {};
+    }
+
+    // Makes up to `size` more bytes available in the view, as many as the
+    // input has left.
+    ZPP_BITS_INLINE constexpr errc refill(std::size_t size)
+    {
+        if constexpr (refillable) {
+            if (size > m_data.size() - m_position) {
+                return m_data.refill(m_position, size);
+            }
+        }
+        return {};
+    }
+
+    // A view that bounds another view, which is kept as is rather than as
+    // a span, so that it follows the other view.
+    constexpr static bool bounded = requires(ByteView view)
+    {
+        view.underlying();
+    };
+
+    using view_type = std::conditional_t<
+        resizable || refillable,
+        ByteView &,
+        std::conditional_t<bounded,
+                           ByteView,
+                           std::remove_cvref_t<decltype(std::span{
+                               std::declval<ByteView &>()})>>>;
 
 private:
+    constexpr auto option(memory_resource resource)
+    {
+        m_memory_resource = resource.resource;
+    }
+
+    // Skips the padding up to the alignment of `Type`, or the alignment of
+    // the archive if smaller, counting from the beginning of the input.
+    template <typename Type>
+    ZPP_BITS_INLINE constexpr errc align_for()
+    {
+        constexpr auto align = std::min(alignof(Type), alignment);
+        if constexpr (align > 1) {
+            // A window rebases the position without saying how far.
+            static_assert(!refillable);
+
+            auto padding = (align - m_position % align) % align;
+            if (padding > m_data.size() - m_position) [[unlikely]] {
+                return std::errc::result_out_of_range;
+            }
+            m_position += padding;
+        }
+        return {};
+    }
+
+    // Reads a run of varints, each with a single load of a whole word while
+    // there are enough bytes left for one.
+    constexpr errc read_varints(auto items)
+    {
+        using type = typename decltype(items)::value_type;
+        constexpr auto encoding = type::encoding;
+        using value_type = std::make_unsigned_t<std::conditional_t<
+            std::is_enum_v<typename type::value_type>,
+            traits::underlying_type_t<typename type::value_type>,
+            typename type::value_type>>;
+
+        std::size_t index{};
+        if constexpr (std::endian::little == std::endian::native &&
+                      varint_word_fits<in, value_type>) {
+            if (!std::is_constant_evaluated()) {
+                // Kept in locals, as the elements written could otherwise
+                // alias them.
+                auto data = m_data.data();
+                auto size = m_data.size();
+                auto position = m_position;
+
+                while (index < items.size()) {
+                    if (size - position < varint_word_room<value_type>)
+                        [[unlikely]] {
+                        if constexpr (!refillable) {
+                            break;
+                        }
+                        m_position = position;
+                        if (auto result = serialize_one(items[index++]);
+                            failure(result)) [[unlikely]] {
+                            return result;
+                        }
+                        data = m_data.data();
+                        size = m_data.size();
+                        position = m_position;
+                        continue;
+                    }
+
+                    value_type value;
+                    if (auto result = decode_varint_word(
+                            data + position, value, position);
+                        failure(result)) [[unlikely]] {
+                        m_position = position;
+                        return result;
+                    }
+                    if constexpr (varint_encoding::zig_zag == encoding) {
+                        items[index].value = decltype(items[index].value)(
+                            (value >> 1) ^ -(value & 0x1));
+                    } else {
+                        items[index].value =
+                            decltype(items[index].value)(value);
+                    }
+                    ++index;
+                }
+                m_position = position;
+            }
+        }
+
+        for (; index < items.size(); ++index) {
+            if (auto result = serialize_one(items[index]); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+        }
+        return {};
+    }
+
+    // Points a view at `count` elements in the input rather than copying
+    // them out, which requires the input to be aligned for them. When it is
+    // not, this fails with `std::errc::invalid_argument`, unless the archive
+    // was given `copy_misaligned`, in which case the elements are copied
+    // into memory from its memory resource, which is never deallocated.
+    template <typename Type>
+    constexpr errc view_elements(const Type *& data, std::size_t count)
+    {
+        // A window moves on, and would leave the view dangling.
+        static_assert(!refillable);
+
+        if (count) {
+            if (auto result = align_for<Type>(); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+        }
+
+        if (count > (m_data.size() - m_position) / sizeof(Type))
+            [[unlikely]] {
+            return std::errc::result_out_of_range;
+        }
+
+        auto size = count * sizeof(Type);
+        auto address = m_data.data() + m_position;
+        if (reinterpret_cast<std::uintptr_t>(address) % alignof(Type))
+            [[unlikely]] {
+            if constexpr (copies_misaligned) {
+                auto copy = m_memory_resource->allocate(size, alignof(Type));
+                std::memcpy(copy, address, size);
+                data = static_cast<const Type *>(copy);
+            } else {
+                return std::errc::invalid_argument;
+            }
+        } else {
+            data = reinterpret_cast<const Type *>(address);
+        }
+
+        m_position += size;
+        return {};
+    }
+
+    // Creates an element to read into before it is inserted into the
+    // container, using the allocator of the container unless it is the
+    // default one, so that inserting moves rather than copies it over.
+    template <typename Type>
+    constexpr Type * make_element(void * address, auto & container)
+    {
+        using allocator_type =
+            typename std::remove_cvref_t<decltype(container)>::allocator_type;
+
+        if constexpr (std::same_as<allocator_type,
+                                   std::allocator<typename allocator_type::
+                                                      value_type>>) {
+            return access::placement_new<Type>(address);
+        } else {
+            return std::uninitialized_construct_using_allocator(
+                static_cast<Type *>(address), container.get_allocator());
+        }
+    }
+
     ZPP_BITS_INLINE constexpr errc serialize_many(auto && first_item,
                                                   auto &&... items)
     {
@@ -2803,9 +4614,13 @@ private:
         } else if constexpr (requires { serialize(*this, item); }) {
             return serialize(*this, item);
         } else if constexpr (std::is_fundamental_v<type> || std::is_enum_v<type>) {
-            auto size = m_data.size();
-            if (sizeof(item) > size - m_position) [[unlikely]] {
-                return std::errc::result_out_of_range;
+            if (auto result = align_for<type>(); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+            if (auto result = fill_for(sizeof(item)); failure(result))
+                [[unlikely]] {
+                return result;
             }
             if (std::is_constant_evaluated()) {
                 std::array<std::remove_const_t<byte_type>, sizeof(item)>
@@ -2839,19 +4654,52 @@ private:
                                      bytes<typename type::value_type>,
                                      type>;
                              }) {
+            // Numbers of the other byte order are reversed as they are
+            // copied in.
+            constexpr auto swapped =
+                endian_aware &&
+                !concepts::byte_type<
+                    std::remove_cvref_t<decltype(*item.data())>>;
             static_assert(
-                !endian_aware ||
-                concepts::byte_type<
+                !swapped ||
+                concepts::serialize_as_swapped_bytes<
+                    in,
                     std::remove_cvref_t<decltype(*item.data())>>);
 
-            auto size = m_data.size();
             auto item_size_in_bytes = item.size_in_bytes();
             if (!item_size_in_bytes) [[unlikely]] {
                 return {};
             }
 
-            if (item_size_in_bytes > size - m_position) [[unlikely]] {
-                return std::errc::result_out_of_range;
+            if (auto result = align_for<typename type::value_type>();
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+
+            if constexpr (refillable) {
+                // Read what does not fit the window into place directly.
+                if (!std::is_constant_evaluated() &&
+                    item_size_in_bytes > m_data.size() - m_position) {
+                    auto result = m_data.read(
+                        m_position,
+                        std::span<std::remove_const_t<byte_type>>{
+                            reinterpret_cast<
+                                std::remove_const_t<byte_type> *>(
+                                item.data()),
+                            item_size_in_bytes});
+                    if constexpr (swapped) {
+                        if (!failure(result)) {
+                            reverse_bytes<sizeof(typename type::value_type)>(
+                                item.data(), item.data(), item.count());
+                        }
+                    }
+                    return result;
+                }
+            }
+
+            if (auto result = fill_for(item_size_in_bytes); failure(result))
+                [[unlikely]] {
+                return result;
             }
             if (std::is_constant_evaluated()) {
                 std::size_t count = item.count();
@@ -2862,19 +4710,25 @@ private:
                     for (std::size_t i = 0;
                          i < sizeof(typename type::value_type);
                          ++i) {
-                        value[i] = byte_type(
-                            m_data[m_position +
-                                   index *
-                                       sizeof(typename type::value_type) +
-                                   i]);
+                        value[swapped ? sizeof(value) - 1 - i : i] =
+                            byte_type(m_data[m_position +
+                                             index * sizeof(
+                                                         typename type::
+                                                             value_type) +
+                                             i]);
                     }
                     item.data()[index] =
                         std::bit_cast<typename type::value_type>(value);
                 }
             } else {
-                std::memcpy(item.data(),
-                            m_data.data() + m_position,
-                            item_size_in_bytes);
+                if constexpr (swapped) {
+                    reverse_bytes<sizeof(typename type::value_type)>(
+                        item.data(), m_data.data() + m_position, item.count());
+                } else {
+                    std::memcpy(item.data(),
+                                m_data.data() + m_position,
+                                item_size_in_bytes);
+                }
             }
             m_position += item_size_in_bytes;
             return {};
@@ -2914,8 +4768,12 @@ private:
         using value_type = std::remove_cvref_t<decltype(array[0])>;
 
         if constexpr (concepts::serialize_as_bytes<decltype(*this),
-                                                   value_type>) {
+                                                   value_type> ||
+                      concepts::serialize_as_swapped_bytes<decltype(*this),
+                                                           value_type>) {
             return serialize_one(bytes(array));
+        } else if constexpr (concepts::varint<value_type>) {
+            return read_varints(std::span{array});
         } else {
             for (auto & item : array) {
                 if (auto result = serialize_one(item); failure(result))
@@ -2927,6 +4785,54 @@ private:
         }
     }
 
+    // Resizes `container` to `size` elements that are serialized as bytes,
+    // and reads them. Rather than value initialize the elements only to
+    // copy over them, reads straight into uninitialized room, or copies the
+    // bytes in with the allocation, where the container allows for it.
+    // Leaves no elements behind that were not read.
+    constexpr errc read_bytes_resized(auto & container, auto size)
+    {
+        using value_type =
+            typename std::remove_cvref_t<decltype(container)>::value_type;
+
+        if constexpr (requires {
+                          container.resize_and_overwrite(
+                              size,
+                              [](auto, auto count) { return count; });
+                      }) {
+            errc result{};
+            container.resize_and_overwrite(size, [&](auto data, auto) {
+                result =
+                    serialize_one(bytes(std::span<value_type>{data, size}));
+                return failure(result) ? decltype(size){} : size;
+            });
+            return result;
+        } else if constexpr (concepts::byte_type<value_type> &&
+                             !refillable &&
+                             requires(const value_type * data) {
+                                 container.assign(data, data);
+                             }) {
+            if (!std::is_constant_evaluated()) {
+                if (size > m_data.size() - m_position) [[unlikely]] {
+                    return std::errc::result_out_of_range;
+                }
+                auto data = reinterpret_cast<const value_type *>(
+                    m_data.data() + m_position);
+                container.assign(data, data + size);
+                m_position += size;
+                return {};
+            }
+        }
+
+        container.resize(size);
+        if (auto result = serialize_one<void>(container); failure(result))
+            [[unlikely]] {
+            container.clear();
+            return result;
+        }
+        return {};
+    }
+
     template <typename SizeType = default_size_type>
     ZPP_BITS_INLINE constexpr errc
     serialize_one(concepts::container auto && container)
@@ -2940,6 +4846,13 @@ private:
                     std::remove_reference_t<decltype(container[0])>>;
             };
 
+        // A view of const elements other than bytes, that is pointed at
+        // the input rather than filled from it.
+        constexpr auto is_typed_view =
+            is_const && !concepts::byte_type<value_type> &&
+            concepts::serialize_as_bytes<decltype(*this), value_type> &&
+            requires(const value_type * data) { type(data, 1); };
+
         if constexpr (!std::is_void_v<SizeType> &&
                       (requires(type container) { container.resize(1); } ||
                        (
@@ -2969,17 +4882,38 @@ private:
                         return std::errc::message_size;
                     }
                 }
-                container.resize(size);
+
+                use_memory_resource(container);
+
+                if constexpr (concepts::serialize_as_bytes<decltype(*this),
+                                                           value_type> ||
+                              concepts::serialize_as_swapped_bytes<
+                                  decltype(*this),
+                                  value_type>) {
+                    return read_bytes_resized(container, size);
+                } else {
+                    container.resize(size);
+                }
             } else if constexpr (is_const &&
                                  (std::same_as<std::byte, value_type> ||
                                   std::same_as<char, value_type> ||
                                   std::same_as<unsigned char,
                                                value_type>)) {
+                // A window moves on, and would leave the view dangling.
+                static_assert(!refillable);
                 if (size > m_data.size() - m_position) [[unlikely]] {
                     return std::errc::result_out_of_range;
                 }
                 container = {m_data.data() + m_position, size};
                 m_position += size;
+            } else if constexpr (is_typed_view) {
+                const value_type * data{};
+                if (auto result = view_elements(data, size);
+                    failure(result)) [[unlikely]] {
+                    return result;
+                }
+                container = type(data, size);
+                return {};
             } else {
                 if (size > container.size()) [[unlikely]] {
                     return std::errc::result_out_of_range;
@@ -2988,13 +4922,15 @@ private:
             }
 
             if constexpr (
-                concepts::serialize_as_bytes<decltype(*this),
-                                             value_type> &&
+                (concepts::serialize_as_bytes<decltype(*this),
+                                              value_type> ||
+                 concepts::serialize_as_swapped_bytes<decltype(*this),
+                                                      value_type>) &&
                 std::is_base_of_v<
                     std::random_access_iterator_tag,
                     typename std::iterator_traits<
                         typename type::iterator>::iterator_category> &&
-                requires { container.data(); } &&
+                requires { container.data(); } && !is_typed_view &&
                 !(is_const &&
                   (std::same_as<std::byte, value_type> ||
                    std::same_as<char, value_type> ||
@@ -3006,8 +4942,10 @@ private:
             }
         }
 
-        if constexpr (concepts::serialize_as_bytes<decltype(*this),
-                                                   value_type> &&
+        if constexpr ((concepts::serialize_as_bytes<decltype(*this),
+                                                    value_type> ||
+                       concepts::serialize_as_swapped_bytes<decltype(*this),
+                                                            value_type>) &&
                       std::is_base_of_v<std::random_access_iterator_tag,
                                         typename std::iterator_traits<
                                             typename type::iterator>::
@@ -3021,6 +4959,7 @@ private:
                                value_type>)&&requires(type container) {
                               container = {m_data.data(), 1};
                           }) {
+                static_assert(!refillable);
                 if constexpr (requires {
                                   requires(type::extent !=
                                            std::dynamic_extent);
@@ -3039,9 +4978,42 @@ private:
                     m_position = size;
                 }
                 return {};
+            } else if constexpr (is_typed_view) {
+                const value_type * data{};
+                if constexpr (requires {
+                                  requires(type::extent !=
+                                           std::dynamic_extent);
+                              }) {
+                    if (auto result = view_elements(data, type::extent);
+                        failure(result)) [[unlikely]] {
+                        return result;
+                    }
+                    container = type(data, type::extent);
+                } else if constexpr (std::is_void_v<SizeType>) {
+                    auto size = m_data.size() - m_position;
+                    if (size % sizeof(value_type)) [[unlikely]] {
+                        return std::errc::bad_message;
+                    }
+                    if (auto result =
+                            view_elements(data, size / sizeof(value_type));
+                        failure(result)) [[unlikely]] {
+                        return result;
+                    }
+                    container = type(data, size / sizeof(value_type));
+                } else {
+                    // A view that was neither read with its size above,
+                    // nor has an extent, cannot tell how much to view.
+                    return std::errc::result_out_of_range;
+                }
+                return {};
             } else {
                 return serialize_one(bytes(container));
             }
+        } else if constexpr (concepts::varint<value_type> &&
+                             std::contiguous_iterator<
+                                 decltype(container.begin())>) {
+            return read_varints(std::span{std::to_address(container.begin()),
+                                          container.size()});
         } else {
             for (auto & item : container) {
                 if (auto result = serialize_one(item); failure(result))
@@ -3079,89 +5051,311 @@ private:
             size = container.size();
         }
 
-        container.clear();
+        // The nodes that the container held are taken aside, to be filled
+        // again rather than freed only for new ones to be allocated.
+        constexpr auto reuses_nodes =
+            requires(type container, typename type::node_type node) {
+                node = container.extract(container.begin());
+                container.insert(container.end(), std::move(node));
+                empty_like(container, container.get_allocator());
+            };
+        auto spare = [&] {
+            if constexpr (reuses_nodes) {
+                auto spare =
+                    empty_like(container, container.get_allocator());
+                spare.swap(container);
+                return spare;
+            } else {
+                container.clear();
+                return nullptr;
+            }
+        }();
+
+        use_memory_resource(container);
+
+        if constexpr (reuses_nodes) {
+            // Nodes may only move between containers of equal allocators.
+            if (spare.get_allocator() != container.get_allocator()) {
+                spare.clear();
+            }
+        }
+
+        if constexpr (requires { container.reserve(std::size_t{}); }) {
+            // Every element takes some input, so a size beyond what is left
+            // is not reserved for up front.
+            container.reserve(std::min(std::size_t(size),
+                                       std::size_t(m_data.size() -
+                                                   m_position)));
+        }
 
         for (std::size_t index{}; index < size; ++index)
         {
+            if constexpr (reuses_nodes) {
+                if (!spare.empty()) {
+                    auto node = spare.extract(spare.begin());
+                    if constexpr (requires { typename type::mapped_type; }) {
+                        if (auto result =
+                                serialize_many(node.key(), node.mapped());
+                            failure(result)) [[unlikely]] {
+                            return result;
+                        }
+                    } else {
+                        if (auto result = serialize_one(node.value());
+                            failure(result)) [[unlikely]] {
+                            return result;
+                        }
+                    }
+
+                    container.insert(container.end(), std::move(node));
+                    continue;
+                }
+            }
+
             if constexpr (requires { typename type::mapped_type; }) {
                 using value_type = std::pair<typename type::key_type,
                                              typename type::mapped_type>;
                 alignas(value_type) std::byte storage[sizeof(value_type)];
 
-                auto object = access::placement_new<value_type>(
-                    std::addressof(storage));
+                auto object = make_element<value_type>(
+                    std::addressof(storage), container);
                 destructor_guard guard{*object};
                 if (auto result = serialize_one(*object); failure(result))
                     [[unlikely]] {
                     return result;
                 }
 
-                container.insert(std::move(*object));
+                insert_element(container, std::move(*object));
             } else {
                 using value_type = typename type::value_type;
 
                 alignas(value_type) std::byte storage[sizeof(value_type)];
 
-                auto object = access::placement_new<value_type>(
-                    std::addressof(storage));
+                auto object = make_element<value_type>(
+                    std::addressof(storage), container);
                 destructor_guard guard{*object};
                 if (auto result = serialize_one(*object); failure(result))
                     [[unlikely]] {
                     return result;
                 }
 
-                container.insert(std::move(*object));
+                insert_element(container, std::move(*object));
             }
         }
 
         return {};
     }
 
+    template <typename SizeType = default_size_type>
     ZPP_BITS_INLINE constexpr errc
-    serialize_one(concepts::tuple auto && tuple)
-    {
-        return serialize_one(tuple,
-                             std::make_index_sequence<std::tuple_size_v<
-                                 std::remove_cvref_t<decltype(tuple)>>>());
-    }
-
-    template <std::size_t... Indices>
-    ZPP_BITS_INLINE constexpr errc serialize_one(
-        concepts::tuple auto && tuple, std::index_sequence<Indices...>)
-    {
-        return serialize_many(std::get<Indices>(tuple)...);
-    }
-
-    ZPP_BITS_INLINE constexpr errc
-    serialize_one(concepts::optional auto && optional)
+    serialize_one(concepts::flat_map auto && container)
     {
-        using value_type = std::remove_reference_t<decltype(*optional)>;
-
-        std::byte has_value{};
-        if (auto result = serialize_one(has_value); failure(result))
-            [[unlikely]] {
-            return result;
-        }
-
-        if (!bool(has_value)) [[unlikely]] {
-            optional = std::nullopt;
-            return {};
-        }
+        using type = std::remove_cvref_t<decltype(container)>;
 
-        if constexpr (std::is_default_constructible_v<value_type>) {
-            if (!optional) {
-                optional = value_type{};
+        // Both sequences are read in place of the ones the container had,
+        // then adopted whole.
+        auto containers = std::move(container).extract();
+        if constexpr (!std::is_void_v<SizeType>) {
+            if (auto result = serialize_one<SizeType>(containers.keys);
+                failure(result)) [[unlikely]] {
+                return result;
             }
 
-            if (auto result = serialize_one(*optional); failure(result))
-                [[unlikely]] {
-                return result;
+            if constexpr (allocation_limit !=
+                          std::numeric_limits<std::size_t>::max()) {
+                constexpr auto limit =
+                    allocation_limit / sizeof(typename type::mapped_type);
+                if (containers.keys.size() > limit) [[unlikely]] {
+                    return std::errc::message_size;
+                }
             }
-        } else {
-            alignas(value_type) std::byte storage[sizeof(value_type)];
 
-            auto object =
-                access::placement_new<value_type>(std::addressof(storage));
+            using mapped_type = typename type::mapped_type;
+            auto size = containers.keys.size();
+            use_memory_resource(containers.values);
+            if constexpr ((concepts::serialize_as_bytes<decltype(*this),
+                                                        mapped_type> ||
+                           concepts::serialize_as_swapped_bytes<
+                               decltype(*this),
+                               mapped_type>) &&
+                          std::is_default_constructible_v<mapped_type>) {
+                // Read as a block, as contiguous containers are.
+                if (auto result =
+                        read_bytes_resized(containers.values, size);
+                    failure(result)) [[unlikely]] {
+                    return result;
+                }
+            } else {
+                // Each value is read into place, rather than initialized
+                // only to be overwritten.
+                containers.values.clear();
+                containers.values.reserve(size);
+                for (std::size_t index = 0; index < size; ++index) {
+                    alignas(mapped_type) std::byte
+                        storage[sizeof(mapped_type)];
+
+                    auto object = make_element<mapped_type>(
+                        std::addressof(storage), containers.values);
+                    destructor_guard guard{*object};
+                    if (auto result = serialize_one(*object);
+                        failure(result)) [[unlikely]] {
+                        return result;
+                    }
+
+                    containers.values.emplace_back(std::move(*object));
+                }
+            }
+        } else {
+            if (auto result = serialize_one<void>(containers.keys);
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+
+            if (auto result = serialize_one<void>(containers.values);
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+        }
+
+        if (is_sorted_for(container, containers.keys)) [[likely]] {
+            container.replace(std::move(containers.keys),
+                              std::move(containers.values));
+        } else {
+            container = type(std::move(containers.keys),
+                             std::move(containers.values),
+                             container.key_comp());
+        }
+        return {};
+    }
+
+    template <typename SizeType = default_size_type>
+    ZPP_BITS_INLINE constexpr errc
+    serialize_one(concepts::flat_set auto && container)
+    {
+        using type = std::remove_cvref_t<decltype(container)>;
+
+        auto elements = std::move(container).extract();
+        if (auto result = serialize_one<SizeType>(elements); failure(result))
+            [[unlikely]] {
+            return result;
+        }
+
+        if (is_sorted_for(container, elements)) [[likely]] {
+            container.replace(std::move(elements));
+        } else {
+            container = type(std::move(elements), container.key_comp());
+        }
+        return {};
+    }
+
+    // Whether the keys are in the order of the container, with no two keys
+    // equal unless the container allows it, so that it may adopt them as
+    // they are. Otherwise the container has to sort them itself.
+    constexpr static bool is_sorted_for(auto & container, auto & keys)
+    {
+        using type = std::remove_cvref_t<decltype(container)>;
+        constexpr auto unique = requires {
+            container.insert(std::declval<typename type::value_type>())
+                .second;
+        };
+
+        auto compare = container.key_comp();
+        return std::adjacent_find(
+                   keys.begin(),
+                   keys.end(),
+                   [&](auto & left, auto & right) {
+                       if constexpr (unique) {
+                           return !compare(left, right);
+                       } else {
+                           return compare(right, left);
+                       }
+                   }) == keys.end();
+    }
+
+    // An empty container that orders and hashes the same way as the given
+    // one, and allocates with `allocator`.
+    constexpr static auto empty_like(auto & container,
+                                     const auto & allocator) requires requires
+    {
+        std::remove_cvref_t<decltype(container)>(container.key_comp(),
+                                                 allocator);
+    }
+    {
+        return std::remove_cvref_t<decltype(container)>(container.key_comp(),
+                                                        allocator);
+    }
+
+    constexpr static auto empty_like(auto & container,
+                                     const auto & allocator) requires requires
+    {
+        std::remove_cvref_t<decltype(container)>(container.bucket_count(),
+                                                 container.hash_function(),
+                                                 container.key_eq(),
+                                                 allocator);
+    }
+    {
+        return std::remove_cvref_t<decltype(container)>(
+            0, container.hash_function(), container.key_eq(), allocator);
+    }
+
+    // Inserts at the end when the container takes a hint, which costs no
+    // more than appending for sorted containers read in their own order.
+    constexpr static void insert_element(auto & container, auto && element)
+    {
+        if constexpr (requires {
+                          container.insert(container.end(),
+                                           std::move(element));
+                      }) {
+            container.insert(container.end(), std::move(element));
+        } else {
+            container.insert(std::move(element));
+        }
+    }
+
+    ZPP_BITS_INLINE constexpr errc
+    serialize_one(concepts::tuple auto && tuple)
+    {
+        return serialize_one(tuple,
+                             std::make_index_sequence<std::tuple_size_v<
+                                 std::remove_cvref_t<decltype(tuple)>>>());
+    }
+
+    template <std::size_t... Indices>
+    ZPP_BITS_INLINE constexpr errc serialize_one(
+        concepts::tuple auto && tuple, std::index_sequence<Indices...>)
+    {
+        return serialize_many(std::get<Indices>(tuple)...);
+    }
+
+    ZPP_BITS_INLINE constexpr errc
+    serialize_one(concepts::optional auto && optional)
+    {
+        using value_type = std::remove_reference_t<decltype(*optional)>;
+
+        std::byte has_value{};
+        if (auto result = serialize_one(has_value); failure(result))
+            [[unlikely]] {
+            return result;
+        }
+
+        if (!bool(has_value)) [[unlikely]] {
+            optional = std::nullopt;
+            return {};
+        }
+
+        if constexpr (std::is_default_constructible_v<value_type>) {
+            if (!optional) {
+                optional = value_type{};
+            }
+
+            if (auto result = serialize_one(*optional); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+        } else {
+            alignas(value_type) std::byte storage[sizeof(value_type)];
+
+            auto object =
+                access::placement_new<value_type>(std::addressof(storage));
             destructor_guard guard{*object};
 
             if (auto result = serialize_one(*object); failure(result))
@@ -3333,14 +5527,68 @@ private:
     {
         using type = std::remove_reference_t<decltype(*pointer)>;
 
-        auto loaded = access::make_unique<type>();;
-        if (auto result = serialize_one(*loaded); failure(result))
-            [[unlikely]] {
-            return result;
-        }
+        if constexpr (has_memory_resource &&
+                      traits::is_shared_ptr<
+                          std::remove_cvref_t<decltype(pointer)>>::value &&
+                      std::is_default_constructible_v<type>) {
+            auto loaded = std::allocate_shared<type>(
+                std::pmr::polymorphic_allocator<type>{m_memory_resource});
+            if (auto result = serialize_one(*loaded); failure(result))
+                [[unlikely]] {
+                return result;
+            }
 
-        pointer.reset(loaded.release());
-        return {};
+            pointer = std::move(loaded);
+            return {};
+        } else if constexpr (std::same_as<
+                                 std::remove_cvref_t<decltype(pointer)>,
+                                 pmr_unique_ptr<type>>) {
+            // Allocated from the memory resource of the archive, or else
+            // from the one that the pointer is already set to free to.
+            pmr_delete<type> deleter{pointer.get_deleter()};
+            if constexpr (has_memory_resource) {
+                deleter.resource = m_memory_resource;
+            }
+
+            // The memory is given back if constructing the object throws,
+            // until the pointer owns it.
+            struct allocation_guard
+            {
+                ~allocation_guard()
+                {
+                    if (address) {
+                        allocator.deallocate(address, 1);
+                    }
+                }
+
+                std::pmr::polymorphic_allocator<type> allocator;
+                type * address;
+            };
+
+            allocation_guard allocation{
+                std::pmr::polymorphic_allocator<type>{deleter.resource},
+                nullptr};
+            allocation.address = allocation.allocator.allocate(1);
+            pmr_unique_ptr<type> loaded{
+                access::placement_new<type>(allocation.address), deleter};
+            allocation.address = nullptr;
+            if (auto result = serialize_one(*loaded); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+
+            pointer = std::move(loaded);
+            return {};
+        } else {
+            auto loaded = access::make_unique<type>();
+            if (auto result = serialize_one(*loaded); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+
+            pointer.reset(loaded.release());
+            return {};
+        }
     }
 
     ZPP_BITS_INLINE constexpr errc
@@ -3349,22 +5597,89 @@ private:
         constexpr auto size = std::remove_cvref_t<decltype(bitset)>{}.size();
         constexpr auto size_in_bytes = (size + (CHAR_BIT - 1)) / CHAR_BIT;
 
-        if (size_in_bytes > m_data.size() - m_position)
+        if (auto result = fill_for(size_in_bytes); failure(result))
             [[unlikely]] {
-            return std::errc::result_out_of_range;
+            return result;
         }
 
         auto data = m_data.data() + m_position;
-        for (std::size_t i = 0; i < size; ++i) {
-            bitset[i] = (static_cast<unsigned char>(data[i / CHAR_BIT]) >>
-                         (i & 0x7)) &
-                        0x1;
+        if constexpr (size <= std::numeric_limits<unsigned long long>::digits) {
+            unsigned long long word{};
+            for (std::size_t i = 0; i < size_in_bytes; ++i) {
+                word |= static_cast<unsigned long long>(
+                            static_cast<unsigned char>(data[i]))
+                        << (i * CHAR_BIT);
+            }
+            bitset = std::remove_cvref_t<decltype(bitset)>(word);
+        } else {
+            bitset.reset();
+            unpack_bits(
+                data, size, [&](auto index) { bitset[index] = true; });
+        }
+
+        m_position += size_in_bytes;
+        return {};
+    }
+
+    template <typename SizeType = default_size_type>
+    ZPP_BITS_INLINE constexpr errc
+    serialize_one(concepts::bit_container auto && container)
+    {
+        std::size_t size = container.size();
+        if constexpr (!std::is_void_v<SizeType>) {
+            SizeType stored_size{};
+            if (auto result = serialize_one(stored_size); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+            size = std::size_t(stored_size);
+
+            if constexpr (allocation_limit !=
+                          std::numeric_limits<std::size_t>::max()) {
+                if (size / CHAR_BIT > allocation_limit) [[unlikely]] {
+                    return std::errc::message_size;
+                }
+            }
+        }
+
+        // The bits must all be there before the container grows.
+        auto size_in_bytes = (size + (CHAR_BIT - 1)) / CHAR_BIT;
+        if (auto result = fill_for(size_in_bytes); failure(result))
+            [[unlikely]] {
+            return result;
+        }
+
+        if constexpr (!std::is_void_v<SizeType>) {
+            use_memory_resource(container);
         }
+        container.assign(size, false);
+        unpack_bits(m_data.data() + m_position, size, [&](auto index) {
+            container[index] = true;
+        });
 
         m_position += size_in_bytes;
         return {};
     }
 
+    // Calls `set` with the index of each bit that is set out of `size` bits
+    // packed by the output archive, skipping over the bytes that are clear.
+    ZPP_BITS_INLINE constexpr static void
+    unpack_bits(auto data, std::size_t size, auto && set)
+    {
+        auto size_in_bytes = (size + (CHAR_BIT - 1)) / CHAR_BIT;
+        for (std::size_t i = 0; i < size_in_bytes; ++i) {
+            auto value = static_cast<unsigned char>(data[i]);
+            if (i * CHAR_BIT + CHAR_BIT > size) {
+                value &= static_cast<unsigned char>(
+                    (1u << (size % CHAR_BIT)) - 1);
+            }
+            while (value) {
+                set(i * CHAR_BIT + std::countr_zero(value));
+                value &= static_cast<unsigned char>(value - 1);
+            }
+        }
+    }
+
     template <typename SizeType = default_size_type>
     ZPP_BITS_INLINE constexpr errc serialize_one(concepts::by_protocol auto && item)
     {
@@ -3405,6 +5720,10 @@ private:
     std::size_t m_position{};
     [[no_unique_address]] traits::nesting_depth_t<nesting_depth_limit>
         m_nesting{};
+    [[no_unique_address]] std::conditional_t<has_memory_resource,
+                                             std::pmr::memory_resource *,
+                                             traits::no_memory_resource>
+        m_memory_resource{};
 };
 
 template <typename Type, std::size_t Size, typename... Options>
@@ -3443,7 +5762,58 @@ constexpr auto in_out(auto && view, auto &&... option)
             std::forward<decltype(option)>(option)...)};
 }
 
-template <typename ByteType = std::byte>
+// An allocator that default initializes the elements that it constructs
+// with no arguments, rather than value initializing them. A vector of bytes
+// then grows without filling the new room with zeros, that the archive
+// overwrites right away, for example:
+// `zpp::bits::data_out<std::byte, zpp::bits::default_init_allocator<std::byte>>()`.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class default_init_allocator : public Allocator
+{
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+public:
+    using Allocator::Allocator;
+
+    template <typename Other>
+    struct rebind
+    {
+        using other = default_init_allocator<
+            Other,
+            typename allocator_traits::template rebind_alloc<Other>>;
+    };
+
+    constexpr default_init_allocator() = default;
+
+    template <typename Other, typename OtherAllocator>
+    constexpr default_init_allocator(
+        const default_init_allocator<Other, OtherAllocator> & other) noexcept :
+        Allocator(static_cast<const OtherAllocator &>(other))
+    {
+    }
+
+    template <typename Other>
+    constexpr void construct(Other * pointer) noexcept(
+        std::is_nothrow_default_constructible_v<Other>)
+    {
+        if (std::is_constant_evaluated()) {
+            std::construct_at(pointer);
+        } else {
+            ::new (static_cast<void *>(pointer)) Other;
+        }
+    }
+
+    template <typename Other, typename... Arguments>
+    constexpr void construct(Other * pointer, Arguments &&... arguments)
+    {
+        allocator_traits::construct(static_cast<Allocator &>(*this),
+                                    pointer,
+                                    std::forward<Arguments>(arguments)...);
+    }
+};
+
+template <typename ByteType = std::byte,
+          typename Allocator = std::allocator<ByteType>>
 constexpr auto data_in_out(auto &&... option)
 {
     struct data_in_out
@@ -3454,14 +5824,15 @@ constexpr auto data_in_out(auto &&... option)
         {
         }
 
-        std::vector<ByteType> data;
+        std::vector<ByteType, Allocator> data;
         in<decltype(data), decltype(option) &...> input;
         out<decltype(data), decltype(option)...> output;
     };
     return data_in_out{std::forward<decltype(option)>(option)...};
 }
 
-template <typename ByteType = std::byte>
+template <typename ByteType = std::byte,
+          typename Allocator = std::allocator<ByteType>>
 constexpr auto data_in(auto &&... option)
 {
     struct data_in
@@ -3471,13 +5842,14 @@ constexpr auto data_in(auto &&... option)
         {
         }
 
-        std::vector<ByteType> data;
+        std::vector<ByteType, Allocator> data;
         in<decltype(data), decltype(option)...> input;
     };
     return data_in{std::forward<decltype(option)>(option)...};
 }
 
-template <typename ByteType = std::byte>
+template <typename ByteType = std::byte,
+          typename Allocator = std::allocator<ByteType>>
 constexpr auto data_out(auto &&... option)
 {
     struct data_out
@@ -3487,422 +5859,1785 @@ constexpr auto data_out(auto &&... option)
         {
         }
 
-        std::vector<ByteType> data;
+        std::vector<ByteType, Allocator> data;
         out<decltype(data), decltype(option)...> output;
     };
     return data_out{std::forward<decltype(option)>(option)...};
 }
 
-template <auto Object, std::size_t MaxSize = 0x1000>
-constexpr auto to_bytes_one()
+// An output view over a staging buffer of fixed size, that hands the bytes
+// written to it off to a sink whenever it runs out of room and at the end of
+// every top level serialization. The memory used is the size of the buffer
+// rather than the size of the output, which can then go directly to a file,
+// a socket or any other destination.
+//
+// The sink is called with a `std::span<const ByteType>` of bytes to write,
+// and returns `errc` (or nothing, if it cannot fail). Bytes that must be
+// written back to after the fact, such as the size of a message that is
+// serialized as it goes, stay in the buffer until they are final, growing
+// it if needed.
+template <typename Sink, typename ByteType = std::byte>
+class sink_buffer
 {
-    constexpr auto size = [] {
-        std::array<std::byte, MaxSize> data;
-        out out{data};
-        out(Object).or_throw();
-        return out.position();
-    }();
+public:
+    using value_type = ByteType;
 
-    if constexpr (!size) {
-        return string_literal<std::byte, 0>{};
-    } else {
-        std::array<std::byte, size> data;
-        out{data}(Object).or_throw();
-        return data;
+    constexpr explicit sink_buffer(Sink sink, std::size_t size = 0x10000) :
+        m_sink(std::move(sink)), m_data(size)
+    {
     }
-}
 
-template <auto... Data>
-constexpr auto join()
-{
-    constexpr auto size = (0 + ... + Data.size());
-    if constexpr (!size) {
-        return string_literal<std::byte, 0>{};
-    } else {
-        std::array<std::byte, size> data;
-        out{data}(Data...).or_throw();
-        return data;
+    constexpr auto data()
+    {
+        return m_data.data();
     }
-}
 
-template <auto Left, auto Right = -1>
-constexpr auto slice(auto array)
-{
-    constexpr auto left = Left;
-    constexpr auto right = (-1 == Right) ? array.size() : Right;
-    constexpr auto size = right - left;
-    static_assert(Left < Right || -1 == Right);
+    constexpr auto data() const
+    {
+        return m_data.data();
+    }
 
-    std::array<std::remove_reference_t<decltype(array[0])>, size> sliced;
-    std::copy(std::begin(array) + left,
-              std::begin(array) + right,
-              std::begin(sliced));
-    return sliced;
-}
+    constexpr std::size_t size() const
+    {
+        return m_data.size();
+    }
 
-template <auto... Object>
-constexpr auto to_bytes()
-{
-    return join<to_bytes_one<Object>()...>();
-}
+    constexpr auto begin()
+    {
+        return m_data.data();
+    }
 
-template <auto Data, typename Type>
-constexpr auto from_bytes()
-{
-    Type object;
-    in{Data}(object).or_throw();
-    return object;
+    constexpr auto end()
+    {
+        return m_data.data() + m_data.size();
+    }
+
+    constexpr auto & operator[](std::size_t index)
+    {
+        return m_data[index];
+    }
+
+    constexpr void resize(std::size_t size)
+    {
+        m_data.resize(size);
+    }
+
+    // Hands the first `position` bytes off to the sink, and rewinds the
+    // position to the beginning of the buffer.
+    constexpr errc flush(std::size_t & position)
+    {
+        if (!position) {
+            return {};
+        }
+
+        if (auto result = hand_off(std::span<const ByteType>{
+                m_data.data(), position});
+            failure(result)) [[unlikely]] {
+            return result;
+        }
+
+        position = 0;
+        return {};
+    }
+
+    // Writes `bytes` following the first `position` bytes of the buffer.
+    // Bytes that do not fit the buffer are handed off to the sink directly,
+    // without staging them.
+    constexpr errc write(std::size_t & position,
+                         std::span<const ByteType> bytes)
+    {
+        if (auto result = flush(position); failure(result)) [[unlikely]] {
+            return result;
+        }
+
+        if (bytes.size() <= m_data.size()) {
+            std::copy(bytes.begin(), bytes.end(), m_data.data());
+            position = bytes.size();
+            return {};
+        }
+
+        return hand_off(bytes);
+    }
+
+    // The number of bytes handed off to the sink so far.
+    constexpr std::size_t flushed() const
+    {
+        return m_flushed;
+    }
+
+    constexpr Sink & sink()
+    {
+        return m_sink;
+    }
+
+private:
+    constexpr errc hand_off(std::span<const ByteType> bytes)
+    {
+        if constexpr (std::is_void_v<decltype(m_sink(bytes))>) {
+            m_sink(bytes);
+        } else if (auto result = errc{m_sink(bytes)}; failure(result))
+            [[unlikely]] {
+            return result;
+        }
+
+        m_flushed += bytes.size();
+        return {};
+    }
+
+    Sink m_sink;
+    std::vector<ByteType> m_data;
+    std::size_t m_flushed{};
+};
+
+// A sink that writes to a stream, such as a file opened with `std::fopen`.
+struct file_sink
+{
+    errc operator()(auto bytes) const
+    {
+        if (std::fwrite(bytes.data(), 1, bytes.size(), file) !=
+            bytes.size()) [[unlikely]] {
+            return std::errc::io_error;
+        }
+        return {};
+    }
+
+    std::FILE * file{};
+};
+
+#if __has_include(<unistd.h>)
+// A sink that writes to a file descriptor, such as a file, pipe or socket.
+struct fd_sink
+{
+    errc operator()(auto bytes) const
+    {
+        auto data = reinterpret_cast<const unsigned char *>(bytes.data());
+        auto size = bytes.size();
+        while (size) {
+            auto written = ::write(fd, data, size);
+            if (written < 0) [[unlikely]] {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return std::errc(errno);
+            }
+            data += written;
+            size -= std::size_t(written);
+        }
+        return {};
+    }
+
+    int fd = -1;
+};
+#endif
+
+// An output view that keeps a reference to every payload of bytes at least
+// as large as a threshold, rather than a copy of it, and grows to hold
+// everything else. The output is then the sequence of segments returned by
+// `segments()` - the bytes of the view up to each reference, followed by
+// the referenced bytes - which can be handed as is to `writev` or `sendmsg`
+// via `iovecs()`, so that large payloads are never copied.
+//
+// Referenced payloads must outlive the use of the segments. Payloads inside
+// of a message whose size is written back once it is done, such as a
+// protobuf message, are copied regardless.
+template <typename ByteType = std::byte>
+class gather_buffer
+{
+public:
+    using value_type = ByteType;
+
+    constexpr explicit gather_buffer(std::size_t threshold = 0x1000) :
+        m_threshold(threshold ? threshold : 1)
+    {
+    }
+
+    constexpr auto data()
+    {
+        return m_data.data();
+    }
+
+    constexpr auto data() const
+    {
+        return m_data.data();
+    }
+
+    constexpr std::size_t size() const
+    {
+        return m_data.size();
+    }
+
+    constexpr auto begin()
+    {
+        return m_data.data();
+    }
+
+    constexpr auto end()
+    {
+        return m_data.data() + m_data.size();
+    }
+
+    constexpr auto & operator[](std::size_t index)
+    {
+        return m_data[index];
+    }
+
+    constexpr void resize(std::size_t size)
+    {
+        m_data.resize(size);
+    }
+
+    constexpr void reserve(std::size_t size)
+    {
+        m_data.reserve(size);
+    }
+
+    // Keeps a reference to `bytes` as following the first `position` bytes
+    // of the view, if they are at least as large as the threshold.
+    constexpr bool reference(std::size_t position,
+                             std::span<const ByteType> bytes)
+    {
+        if (bytes.size() < m_threshold) {
+            return false;
+        }
+        m_references.push_back({position, bytes});
+        return true;
+    }
+
+    // The segments of the output, in order, given the position of the
+    // archive at the end of it.
+    constexpr auto segments(std::size_t position) const
+    {
+        std::vector<std::span<const ByteType>> segments;
+        segments.reserve(m_references.size() * 2 + 1);
+
+        std::size_t begin = 0;
+        for (auto & [end, bytes] : m_references) {
+            if (end != begin) {
+                segments.emplace_back(m_data.data() + begin, end - begin);
+            }
+            segments.push_back(bytes);
+            begin = end;
+        }
+        if (position != begin) {
+            segments.emplace_back(m_data.data() + begin, position - begin);
+        }
+        return segments;
+    }
+
+#if __has_include(<sys/uio.h>)
+    auto iovecs(std::size_t position) const
+    {
+        std::vector<::iovec> iovecs;
+        for (auto segment : segments(position)) {
+            iovecs.push_back(
+                {const_cast<ByteType *>(segment.data()), segment.size()});
+        }
+        return iovecs;
+    }
+#endif
+
+    // The size of the output, given the position of the archive at the end
+    // of it.
+    constexpr std::size_t output_size(std::size_t position) const
+    {
+        std::size_t size = position;
+        for (auto & reference : m_references) {
+            size += reference.second.size();
+        }
+        return size;
+    }
+
+    // Forgets the references, to start over with the view.
+    constexpr void clear()
+    {
+        m_data.clear();
+        m_references.clear();
+    }
+
+private:
+    std::vector<ByteType> m_data;
+    std::vector<std::pair<std::size_t, std::span<const ByteType>>>
+        m_references;
+    std::size_t m_threshold{};
+};
+
+// A pool of chunks of fixed size, for chunk buffers to draw from and return
+// to, so that chunks are allocated once and reused.
+template <typename ByteType = std::byte>
+class chunk_pool
+{
+public:
+    constexpr explicit chunk_pool(std::size_t chunk_size = 0x10000) :
+        m_chunk_size(chunk_size ? chunk_size : 1)
+    {
+    }
+
+    constexpr std::size_t chunk_size() const
+    {
+        return m_chunk_size;
+    }
+
+    constexpr std::unique_ptr<ByteType[]> acquire()
+    {
+        if (m_free.empty()) {
+            return std::unique_ptr<ByteType[]>(new ByteType[m_chunk_size]);
+        }
+        auto chunk = std::move(m_free.back());
+        m_free.pop_back();
+        return chunk;
+    }
+
+    constexpr void release(std::unique_ptr<ByteType[]> chunk)
+    {
+        m_free.push_back(std::move(chunk));
+    }
+
+private:
+    std::vector<std::unique_ptr<ByteType[]>> m_free;
+    std::size_t m_chunk_size{};
+};
+
+// An output view made of a chain of chunks drawn from a pool, that moves on
+// to a new chunk when it runs out of room instead of growing, so that bytes
+// that were written are never copied again. Payloads of bytes that cross the
+// end of a chunk are split across chunks.
+//
+// The output is the sequence of spans returned by `processed_data()` of the
+// archive. Bytes that must be written back to after the fact, such as the
+// size of a message that is serialized as it goes, are kept contiguous,
+// and a message of that kind that outgrows a chunk is moved to a larger
+// chunk of its own.
+template <typename ByteType = std::byte>
+class chunk_buffer
+{
+public:
+    using value_type = ByteType;
+
+    constexpr explicit chunk_buffer(chunk_pool<ByteType> & pool) :
+        m_pool(&pool)
+    {
+    }
+
+    chunk_buffer(const chunk_buffer &) = delete;
+    chunk_buffer & operator=(const chunk_buffer &) = delete;
+
+    constexpr ~chunk_buffer()
+    {
+        clear();
+    }
+
+    constexpr auto data()
+    {
+        return m_data;
+    }
+
+    constexpr const ByteType * data() const
+    {
+        return m_data;
+    }
+
+    constexpr std::size_t size() const
+    {
+        return m_size;
+    }
+
+    constexpr auto begin()
+    {
+        return m_data;
+    }
+
+    constexpr auto end()
+    {
+        return m_data + m_size;
+    }
+
+    constexpr auto & operator[](std::size_t index)
+    {
+        return m_data[index];
+    }
+
+    // Makes the current room `size` bytes large, keeping its contents.
+    constexpr void resize(std::size_t size)
+    {
+        if (size <= m_size) {
+            m_size = size;
+            return;
+        }
+
+        auto chunk_size = m_pool->chunk_size();
+        auto data = size <= chunk_size
+                        ? m_pool->acquire()
+                        : std::unique_ptr<ByteType[]>(new ByteType[size]);
+        std::copy_n(m_data, m_size, data.get());
+
+        // A chunk that was all room has nothing else in it.
+        if (!m_chunks.empty() && m_chunks.back().data.get() == m_data) {
+            release(std::move(m_chunks.back()));
+            m_chunks.pop_back();
+        }
+
+        m_data = data.get();
+        m_size = std::max(size, chunk_size);
+        m_chunks.push_back({std::move(data), m_size});
+    }
+
+    // Completes the first `position` bytes of the current room, leaving
+    // the rest of it for what follows, or moving on to a new chunk if too
+    // little is left.
+    constexpr errc flush(std::size_t & position)
+    {
+        if (position) {
+            m_segments.emplace_back(m_data, position);
+            m_data += position;
+            m_size -= position;
+            position = 0;
+        }
+
+        if (m_size < std::min(minimum_room, m_pool->chunk_size() / 2)) {
+            next_chunk();
+        }
+        return {};
+    }
+
+    // Writes `bytes` following the first `position` bytes of the current
+    // room, continuing in new chunks as needed.
+    constexpr errc write(std::size_t & position,
+                         std::span<const ByteType> bytes)
+    {
+        while (true) {
+            auto count = std::min(bytes.size(), m_size - position);
+            std::copy_n(bytes.data(), count, m_data + position);
+            position += count;
+            bytes = bytes.subspan(count);
+            if (bytes.empty()) {
+                return {};
+            }
+
+            m_segments.emplace_back(m_data, position);
+            position = 0;
+            next_chunk();
+        }
+    }
+
+    // The output so far, given the position of the archive.
+    constexpr auto processed_data(std::size_t position) const
+    {
+        auto segments = m_segments;
+        if (position) {
+            segments.emplace_back(m_data, position);
+        }
+        return segments;
+    }
+
+    // Returns every chunk to the pool, to start over with the view.
+    constexpr void clear()
+    {
+        for (auto & chunk : m_chunks) {
+            release(std::move(chunk));
+        }
+        m_chunks.clear();
+        m_segments.clear();
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+private:
+    // Room that is left in a chunk below this is not worth filling.
+    constexpr static std::size_t minimum_room = 64;
+
+    struct chunk
+    {
+        std::unique_ptr<ByteType[]> data;
+        std::size_t size{};
+    };
+
+    constexpr void next_chunk()
+    {
+        m_chunks.push_back({m_pool->acquire(), m_pool->chunk_size()});
+        m_data = m_chunks.back().data.get();
+        m_size = m_chunks.back().size;
+    }
+
+    constexpr void release(chunk && chunk)
+    {
+        if (chunk.size == m_pool->chunk_size()) {
+            m_pool->release(std::move(chunk.data));
+        }
+    }
+
+    chunk_pool<ByteType> * m_pool{};
+    std::vector<chunk> m_chunks;
+    std::vector<std::span<const ByteType>> m_segments;
+    ByteType * m_data{};
+    std::size_t m_size{};
+};
+
+template <auto Object, std::size_t MaxSize = 0x1000>
+constexpr auto to_bytes_one()
+{
+    constexpr auto size = [] {
+        // Bounded objects need no more room than their maximum size.
+        constexpr auto probe_size = [] {
+            if constexpr (concepts::bounded_serialized_size<
+                              decltype(Object)>) {
+                return max_serialized_size_v<decltype(Object)>;
+            } else {
+                return MaxSize;
+            }
+        }();
+        std::array<std::byte, probe_size> data;
+        out out{data};
+        out(Object).or_throw();
+        return out.position();
+    }();
+
+    if constexpr (!size) {
+        return string_literal<std::byte, 0>{};
+    } else {
+        std::array<std::byte, size> data;
+        out{data}(Object).or_throw();
+        return data;
+    }
+}
+
+template <auto... Data>
+constexpr auto join()
+{
+    constexpr auto size = (0 + ... + Data.size());
+    if constexpr (!size) {
+        return string_literal<std::byte, 0>{};
+    } else {
+        std::array<std::byte, size> data;
+        out{data}(Data...).or_throw();
+        return data;
+    }
+}
+
+template <auto Left, auto Right = -1>
+constexpr auto slice(auto array)
+{
+    constexpr auto left = Left;
+    constexpr auto right = (-1 == Right) ? array.size() : Right;
+    constexpr auto size = right - left;
+    static_assert(Left < Right || -1 == Right);
+
+    std::array<std::remove_reference_t<decltype(array[0])>, size> sliced;
+    std::copy(std::begin(array) + left,
+              std::begin(array) + right,
+              std::begin(sliced));
+    return sliced;
+}
+
+template <auto... Object>
+constexpr auto to_bytes()
+{
+    return join<to_bytes_one<Object>()...>();
+}
+
+template <auto Data, typename Type>
+constexpr auto from_bytes()
+{
+    Type object;
+    in{Data}(object).or_throw();
+    return object;
+}
+
+template <auto Data, typename... Types>
+constexpr auto from_bytes() requires (sizeof...(Types) > 1)
+{
+    std::tuple<Types...> object;
+    in{Data}(object).or_throw();
+    return object;
+}
+
+template <auto Id, auto MaxSize = -1>
+constexpr auto serialize_id()
+{
+    constexpr auto serialized_id = slice<0, MaxSize>(to_bytes<Id>());
+    if constexpr (sizeof(serialized_id) == 1) {
+        return serialization_id<from_bytes<serialized_id, std::byte>()>{};
+    } else if constexpr (sizeof(serialized_id) == 2) {
+        return serialization_id<from_bytes<serialized_id, std::uint16_t>()>{};
+    } else if constexpr (sizeof(serialized_id) == 4) {
+        return serialization_id<from_bytes<serialized_id, std::uint32_t>()>{};
+    } else if constexpr (sizeof(serialized_id) == 8) {
+        return serialization_id<from_bytes<serialized_id, std::uint64_t>()>{};
+    } else {
+        return serialization_id<serialized_id>{};
+    }
+}
+
+template <auto Id, auto MaxSize = -1>
+using id = decltype(serialize_id<Id, MaxSize>());
+
+template <auto Id, auto MaxSize = -1>
+constexpr auto id_v = id<Id, MaxSize>::value;
+
+template <typename Id, concepts::variant Variant>
+struct known_id_variant
+{
+    constexpr explicit known_id_variant(Variant & variant) :
+        variant(variant)
+    {
+    }
+
+    ZPP_BITS_INLINE constexpr static auto serialize(auto & serializer,
+                                                    auto & self)
+    {
+        return serializer.template serialize_one<Id>(self.variant);
+    }
+
+    Variant & variant;
+};
+
+template <auto Id, auto MaxSize = -1, typename Variant>
+constexpr auto known_id(Variant && variant)
+{
+    return known_id_variant<id<Id, MaxSize>,
+                            std::remove_reference_t<Variant>>(variant);
+}
+
+template <typename Id, concepts::variant Variant>
+struct known_dynamic_id_variant
+{
+    using id_type =
+        std::conditional_t<std::is_integral_v<std::remove_cvref_t<Id>> ||
+                               std::is_enum_v<std::remove_cvref_t<Id>>,
+                           std::remove_cvref_t<Id>,
+                           Id &>;
+
+    constexpr explicit known_dynamic_id_variant(Variant & variant, id_type id) :
+        variant(variant),
+        id(id)
+    {
+    }
+
+    ZPP_BITS_INLINE constexpr static auto serialize(auto & serializer,
+                                                    auto & self)
+    {
+        return serializer.serialize_one(self.variant, self.id);
+    }
+
+    Variant & variant;
+    id_type id;
+};
+
+template <typename Id, typename Variant>
+constexpr auto known_id(Id && id, Variant && variant)
+{
+    return known_dynamic_id_variant<Id, std::remove_reference_t<Variant>>(
+        variant, id);
+}
+
+template <typename Function>
+struct function_traits;
+
+template <typename Return, typename... Arguments>
+struct function_traits<Return(*)(Arguments...)>
+{
+    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
+    using return_type = Return;
+};
+
+template <typename Return, typename... Arguments>
+struct function_traits<Return(*)(Arguments...) noexcept>
+{
+    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
+    using return_type = Return;
+};
+
+template <typename This, typename Return, typename... Arguments>
+struct function_traits<Return(This::*)(Arguments...)>
+{
+    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
+    using return_type = Return;
+};
+
+template <typename This, typename Return, typename... Arguments>
+struct function_traits<Return(This::*)(Arguments...) noexcept>
+{
+    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
+    using return_type = Return;
+};
+
+template <typename This, typename Return, typename... Arguments>
+struct function_traits<Return(This::*)(Arguments...) const>
+{
+    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
+    using return_type = Return;
+};
+
+template <typename This, typename Return, typename... Arguments>
+struct function_traits<Return(This::*)(Arguments...) const noexcept>
+{
+    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
+    using return_type = Return;
+};
+
+template <typename Return>
+struct function_traits<Return(*)()>
+{
+    using parameters_type = void;
+    using return_type = Return;
+};
+
+template <typename Return>
+struct function_traits<Return(*)() noexcept>
+{
+    using parameters_type = void;
+    using return_type = Return;
+};
+
+template <typename This, typename Return>
+struct function_traits<Return(This::*)()>
+{
+    using parameters_type = void;
+    using return_type = Return;
+};
+
+template <typename This, typename Return>
+struct function_traits<Return(This::*)() noexcept>
+{
+    using parameters_type = void;
+    using return_type = Return;
+};
+
+template <typename This, typename Return>
+struct function_traits<Return(This::*)() const>
+{
+    using parameters_type = void;
+    using return_type = Return;
+};
+
+template <typename This, typename Return>
+struct function_traits<Return(This::*)() const noexcept>
+{
+    using parameters_type = void;
+    using return_type = Return;
+};
+
+template <typename Function>
+using function_parameters_t =
+    typename function_traits<std::remove_cvref_t<Function>>::parameters_type;
+
+template <typename Function>
+using function_return_type_t =
+    typename function_traits<std::remove_cvref_t<Function>>::return_type;
+
+constexpr auto success(auto && value_or_errc) requires
+    std::same_as<decltype(value_or_errc.error()), errc>
+{
+    return value_or_errc.success();
+}
+
+constexpr auto failure(auto && value_or_errc) requires
+    std::same_as<decltype(value_or_errc.error()), errc>
+{
+    return value_or_errc.failure();
 }
 
-template <auto Data, typename... Types>
-constexpr auto from_bytes() requires (sizeof...(Types) > 1)
+template <typename Type>
+struct [[nodiscard]] value_or_errc
+{
+    using error_type = errc;
+    using value_type = std::conditional_t<
+        std::is_void_v<Type>,
+        std::nullptr_t,
+        std::conditional_t<
+            std::is_reference_v<Type>,
+            std::add_pointer_t<std::remove_reference_t<Type>>,
+            Type>>;
+
+    constexpr value_or_errc() = default;
+
+    constexpr explicit value_or_errc(auto && value) :
+        m_return_value(std::forward<decltype(value)>(value))
+    {
+    }
+
+    constexpr explicit value_or_errc(error_type error) :
+        m_error(std::forward<decltype(error)>(error)),
+        m_failure(true)
+    {
+    }
+
+    constexpr value_or_errc(value_or_errc && other) noexcept
+    {
+        if (other.success()) {
+            if constexpr (!std::is_void_v<Type>) {
+                if constexpr (!std::is_reference_v<Type>) {
+                    ::new (std::addressof(m_return_value))
+                        Type(std::move(other.m_return_value));
+                } else {
+                    m_return_value = other.m_return_value;
+                }
+            }
+        } else {
+            m_failure = other.m_failure;
+            std::memcpy(&m_error, &other.m_error, sizeof(m_error));
+        }
+    }
+
+    constexpr ~value_or_errc()
+    {
+        if constexpr (!std::is_void_v<Type> &&
+                      !std::is_trivially_destructible_v<Type>) {
+            if (success()) {
+                m_return_value.~Type();
+            }
+        }
+    }
+
+    constexpr bool success() const noexcept
+    {
+        return !m_failure;
+    }
+
+    constexpr bool failure() const noexcept
+    {
+        return m_failure;
+    }
+
+    constexpr decltype(auto) value() & noexcept
+    {
+        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
+            return (m_return_value);
+        } else {
+            return (*m_return_value);
+        }
+    }
+
+    constexpr decltype(auto) value() && noexcept
+    {
+        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
+            return std::forward<Type>(m_return_value);
+        } else {
+            return std::forward<Type>(*m_return_value);
+        }
+    }
+
+    constexpr decltype(auto) value() const & noexcept
+    {
+        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
+            return (m_return_value);
+        } else {
+            return (*m_return_value);
+        }
+    }
+
+    constexpr auto error() const noexcept
+    {
+        return m_error;
+    }
+
+    #if __has_include("zpp_throwing.h")
+    constexpr zpp::throwing<Type> operator co_await() &&
+    {
+        if (failure()) [[unlikely]] {
+            return error().code;
+        }
+        return std::move(*this).value();
+    }
+
+    constexpr zpp::throwing<Type> operator co_await() const &
+    {
+        if (failure()) [[unlikely]] {
+            return error().code;
+        }
+        return value();
+    }
+#endif
+
+    constexpr decltype(auto) or_throw() &
+    {
+        if (failure()) [[unlikely]] {
+#ifdef __cpp_exceptions
+            throw std::system_error(std::make_error_code(error().code));
+#else
+            std::abort();
+#endif
+        }
+        return value();
+    }
+
+    constexpr decltype(auto) or_throw() &&
+    {
+        if (failure()) [[unlikely]] {
+#ifdef __cpp_exceptions
+            throw std::system_error(std::make_error_code(error().code));
+#else
+            std::abort();
+#endif
+        }
+        return std::move(*this).value();
+    }
+
+    constexpr decltype(auto) or_throw() const &
+    {
+        if (failure()) [[unlikely]] {
+#ifdef __cpp_exceptions
+            throw std::system_error(std::make_error_code(error().code));
+#else
+            std::abort();
+#endif
+        }
+        return value();
+    }
+
+    union
+    {
+        error_type m_error{};
+        value_type m_return_value;
+    };
+    bool m_failure{};
+};
+
+// An output view that counts the bytes written to it rather than keeping
+// them. Fundamentals pass through a small scratch buffer that is rewound
+// whenever it runs out of room, and payloads of bytes are counted without
+// being copied, so the memory used does not depend on the size of the
+// output. Output archives over it never write back into it, such as to
+// fill in the size of a message.
+template <typename ByteType = std::byte>
+class counting_buffer
 {
-    std::tuple<Types...> object;
-    in{Data}(object).or_throw();
-    return object;
-}
+public:
+    using value_type = ByteType;
 
-template <auto Id, auto MaxSize = -1>
-constexpr auto serialize_id()
+    constexpr explicit counting_buffer(std::size_t size = 0x100) :
+        m_data(size ? size : 1)
+    {
+    }
+
+    constexpr auto data()
+    {
+        return m_data.data();
+    }
+
+    constexpr auto data() const
+    {
+        return m_data.data();
+    }
+
+    constexpr std::size_t size() const
+    {
+        return m_data.size();
+    }
+
+    constexpr auto begin()
+    {
+        return m_data.data();
+    }
+
+    constexpr auto end()
+    {
+        return m_data.data() + m_data.size();
+    }
+
+    constexpr auto & operator[](std::size_t index)
+    {
+        return m_data[index];
+    }
+
+    constexpr void resize(std::size_t size)
+    {
+        m_data.resize(size);
+    }
+
+    // Counts the first `position` bytes, and rewinds the position to the
+    // beginning of the buffer.
+    constexpr errc flush(std::size_t & position)
+    {
+        m_flushed += position;
+        position = 0;
+        return {};
+    }
+
+    constexpr errc write(std::size_t & position,
+                         std::span<const ByteType> bytes)
+    {
+        count(position, bytes.size());
+        return {};
+    }
+
+    // Counts `size` bytes following the first `position` bytes, without
+    // their content.
+    constexpr void count(std::size_t & position, std::size_t size)
+    {
+        m_flushed += position + size;
+        position = 0;
+    }
+
+    // The number of bytes counted so far.
+    constexpr std::size_t flushed() const
+    {
+        return m_flushed;
+    }
+
+private:
+    std::vector<ByteType> m_data;
+    std::size_t m_flushed{};
+};
+
+// The number of bytes that an output archive given `Options` writes when
+// serializing `items`, without keeping them. This is exactly as many bytes
+// as the output takes, so that the output buffer can be sized once in
+// advance, and for types that serialize as their bytes it is a constant.
+template <typename... Options>
+constexpr value_or_errc<std::size_t> serialized_size(auto &&... items)
 {
-    constexpr auto serialized_id = slice<0, MaxSize>(to_bytes<Id>());
-    if constexpr (sizeof(serialized_id) == 1) {
-        return serialization_id<from_bytes<serialized_id, std::byte>()>{};
-    } else if constexpr (sizeof(serialized_id) == 2) {
-        return serialization_id<from_bytes<serialized_id, std::uint16_t>()>{};
-    } else if constexpr (sizeof(serialized_id) == 4) {
-        return serialization_id<from_bytes<serialized_id, std::uint32_t>()>{};
-    } else if constexpr (sizeof(serialized_id) == 8) {
-        return serialization_id<from_bytes<serialized_id, std::uint64_t>()>{};
+    using archive_type = basic_out<std::span<std::byte>, Options...>;
+
+    if constexpr (archive_type::alignment == 1 &&
+                  (... && concepts::serialize_as_bytes<
+                              archive_type,
+                              std::remove_cvref_t<decltype(items)>>)) {
+        return value_or_errc<std::size_t>{(0 + ... + sizeof(items))};
     } else {
-        return serialization_id<serialized_id>{};
+        counting_buffer buffer;
+        out out{buffer, Options{}...};
+        if (auto result = out(items...); failure(result)) [[unlikely]] {
+            return value_or_errc<std::size_t>{result};
+        }
+        return value_or_errc<std::size_t>{buffer.flushed() + out.position()};
     }
 }
 
-template <auto Id, auto MaxSize = -1>
-using id = decltype(serialize_id<Id, MaxSize>());
+// An input view over a window of fixed size, that is refilled from a source
+// as the input archive reads through it, so that an input of any size can be
+// read with no more memory than the window - straight from a file, a pipe or
+// a socket.
+//
+// The source is called with a `std::span<ByteType>` to read into, and
+// returns the number of bytes read, zero at the end of the input, either as
+// `value_or_errc<std::size_t>` or as a plain integer if it cannot fail.
+// Values that have to be read from one contiguous range, such as protobuf
+// messages, grow the window to fit if needed, up to `max_size` bytes, so
+// that a size read from the input cannot make the window grow without
+// bound.
+template <typename Source, typename ByteType = std::byte>
+class source_buffer
+{
+public:
+    using value_type = ByteType;
 
-template <auto Id, auto MaxSize = -1>
-constexpr auto id_v = id<Id, MaxSize>::value;
+    constexpr explicit source_buffer(Source source,
+                                     std::size_t size = 0x10000,
+                                     std::size_t max_size = 0x1000000) :
+        m_source(std::move(source)),
+        m_data(size ? size : 1),
+        m_max_size(std::max(max_size, m_data.size()))
+    {
+    }
 
-template <typename Id, concepts::variant Variant>
-struct known_id_variant
-{
-    constexpr explicit known_id_variant(Variant & variant) :
-        variant(variant)
+    constexpr auto data()
     {
+        return m_data.data();
     }
 
-    ZPP_BITS_INLINE constexpr static auto serialize(auto & serializer,
-                                                    auto & self)
+    constexpr auto data() const
     {
-        return serializer.template serialize_one<Id>(self.variant);
+        return m_data.data();
     }
 
-    Variant & variant;
+    // The number of bytes in the window, which is where reading stops
+    // until the next refill.
+    constexpr std::size_t size() const
+    {
+        return m_size;
+    }
+
+    constexpr auto begin()
+    {
+        return m_data.data();
+    }
+
+    constexpr auto end()
+    {
+        return m_data.data() + m_size;
+    }
+
+    constexpr auto & operator[](std::size_t index)
+    {
+        return m_data[index];
+    }
+
+    // Moves the bytes from `position` onwards to the beginning of the
+    // window, rewinding the position, then reads until there are at least
+    // `minimum` bytes in the window or the input ends. Fails with
+    // `std::errc::message_size` if that takes a window larger than the
+    // maximum.
+    constexpr errc refill(std::size_t & position, std::size_t minimum)
+    {
+        if (position) {
+            std::copy(m_data.data() + position,
+                      m_data.data() + m_size,
+                      m_data.data());
+            m_size -= position;
+            position = 0;
+        }
+
+        while (m_size < minimum && !m_end) {
+            if (m_size == m_data.size()) {
+                if (m_size == m_max_size) [[unlikely]] {
+                    return std::errc::message_size;
+                }
+                m_data.resize(std::min(m_data.size() * 2, m_max_size));
+            }
+            auto result = read_some(std::span<ByteType>{
+                m_data.data() + m_size, m_data.size() - m_size});
+            if (failure(result)) [[unlikely]] {
+                return result.error();
+            }
+            m_size += result.value();
+        }
+        return {};
+    }
+
+    // Reads `bytes.size()` bytes from `position` onwards into `bytes`,
+    // consuming the window first. Reads that are large compared to the
+    // window go directly from the source into `bytes`.
+    constexpr errc read(std::size_t & position, std::span<ByteType> bytes)
+    {
+        auto available = std::min(bytes.size(), m_size - position);
+        std::copy_n(m_data.data() + position, available, bytes.data());
+        position += available;
+        bytes = bytes.subspan(available);
+        if (bytes.empty()) {
+            return {};
+        }
+
+        if (bytes.size() < m_data.size() / 2) {
+            if (auto result = refill(position, bytes.size());
+                failure(result)) [[unlikely]] {
+                return result;
+            }
+            if (bytes.size() > m_size) [[unlikely]] {
+                return std::errc::result_out_of_range;
+            }
+            std::copy_n(m_data.data(), bytes.size(), bytes.data());
+            position = bytes.size();
+            return {};
+        }
+
+        while (!bytes.empty()) {
+            auto result = read_some(bytes);
+            if (failure(result)) [[unlikely]] {
+                return result.error();
+            }
+            if (!result.value()) [[unlikely]] {
+                return std::errc::result_out_of_range;
+            }
+            bytes = bytes.subspan(result.value());
+        }
+        return {};
+    }
+
+    constexpr Source & source()
+    {
+        return m_source;
+    }
+
+private:
+    constexpr value_or_errc<std::size_t> read_some(std::span<ByteType> bytes)
+    {
+        if constexpr (std::integral<decltype(m_source(bytes))>) {
+            std::size_t count = m_source(bytes);
+            m_end = !count;
+            return value_or_errc<std::size_t>{count};
+        } else {
+            auto result = m_source(bytes);
+            if (failure(result)) [[unlikely]] {
+                return value_or_errc<std::size_t>{result.error()};
+            }
+            m_end = !result.value();
+            return value_or_errc<std::size_t>{std::size_t(result.value())};
+        }
+    }
+
+    Source m_source;
+    std::vector<ByteType> m_data;
+    std::size_t m_max_size{};
+    std::size_t m_size{};
+    bool m_end{};
 };
 
-template <auto Id, auto MaxSize = -1, typename Variant>
-constexpr auto known_id(Variant && variant)
+// A source that reads from a stream, such as a file opened with
+// `std::fopen`.
+struct file_source
 {
-    return known_id_variant<id<Id, MaxSize>,
-                            std::remove_reference_t<Variant>>(variant);
-}
+    value_or_errc<std::size_t> operator()(auto bytes) const
+    {
+        auto count = std::fread(bytes.data(), 1, bytes.size(), file);
+        if (!count && std::ferror(file)) [[unlikely]] {
+            return value_or_errc<std::size_t>{errc{std::errc::io_error}};
+        }
+        return value_or_errc<std::size_t>{count};
+    }
 
-template <typename Id, concepts::variant Variant>
-struct known_dynamic_id_variant
+    std::FILE * file{};
+};
+
+#if __has_include(<unistd.h>)
+// A source that reads from a file descriptor, such as a file, pipe or
+// socket.
+struct fd_source
 {
-    using id_type =
-        std::conditional_t<std::is_integral_v<std::remove_cvref_t<Id>> ||
-                               std::is_enum_v<std::remove_cvref_t<Id>>,
-                           std::remove_cvref_t<Id>,
-                           Id &>;
+    value_or_errc<std::size_t> operator()(auto bytes) const
+    {
+        while (true) {
+            auto count = ::read(fd, bytes.data(), bytes.size());
+            if (count < 0) [[unlikely]] {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return value_or_errc<std::size_t>{errc{std::errc(errno)}};
+            }
+            return value_or_errc<std::size_t>{std::size_t(count)};
+        }
+    }
+
+    int fd = -1;
+};
+#endif
+
+// An input view over a chain of buffers, such as the buffers that a message
+// was received into, that reads across the boundaries between them as if
+// they were one. Values within a buffer are read from it in place, and only
+// values that cross into the next buffer are copied together first.
+//
+// The buffers must outlive the view, which does not own them.
+template <typename ByteType = std::byte>
+class segmented_buffer
+{
+public:
+    using value_type = ByteType;
+
+    constexpr explicit segmented_buffer(
+        std::span<const std::span<const ByteType>> segments) :
+        m_segments(segments)
+    {
+    }
+
+    constexpr const ByteType * data() const
+    {
+        return m_data;
+    }
+
+    // The number of bytes that can be read in place, up to the next
+    // boundary.
+    constexpr std::size_t size() const
+    {
+        return m_size;
+    }
+
+    constexpr const ByteType * begin() const
+    {
+        return m_data;
+    }
+
+    constexpr const ByteType * end() const
+    {
+        return m_data + m_size;
+    }
+
+    constexpr const ByteType & operator[](std::size_t index) const
+    {
+        return m_data[index];
+    }
+
+    // Makes at least `minimum` bytes from `position` onwards readable in
+    // place, as many as there are left, copying the bytes that cross a
+    // boundary together.
+    constexpr errc refill(std::size_t & position, std::size_t minimum)
+    {
+        if (position == m_size) {
+            next_segment();
+            position = 0;
+        }
+
+        if (minimum <= m_size - position) {
+            return {};
+        }
+
+        // Reuse the stitch buffer in place if it is the current one.
+        if (m_data == m_stitch.data()) {
+            m_stitch.erase(m_stitch.begin(),
+                           m_stitch.begin() + std::ptrdiff_t(position));
+        } else {
+            m_stitch.assign(m_data + position, m_data + m_size);
+        }
+
+        while (m_stitch.size() < minimum && m_index < m_segments.size()) {
+            auto segment = m_segments[m_index].subspan(m_offset);
+            auto count = std::min(minimum - m_stitch.size(), segment.size());
+            m_stitch.insert(
+                m_stitch.end(), segment.begin(), segment.begin() + count);
+            advance(count);
+        }
+
+        m_data = m_stitch.data();
+        m_size = m_stitch.size();
+        position = 0;
+        return {};
+    }
+
+    // Reads `bytes.size()` bytes from `position` onwards into `bytes`.
+    constexpr errc read(std::size_t & position, std::span<ByteType> bytes)
+    {
+        auto available = std::min(bytes.size(), m_size - position);
+        std::copy_n(m_data + position, available, bytes.data());
+        position += available;
+        bytes = bytes.subspan(available);
+
+        while (!bytes.empty()) {
+            if (m_index == m_segments.size()) [[unlikely]] {
+                return std::errc::result_out_of_range;
+            }
+            auto segment = m_segments[m_index].subspan(m_offset);
+            auto count = std::min(bytes.size(), segment.size());
+            std::copy_n(segment.data(), count, bytes.data());
+            bytes = bytes.subspan(count);
+            advance(count);
+
+            // Nothing is left in place, the next refill moves on.
+            position = m_size;
+        }
+        return {};
+    }
 
-    constexpr explicit known_dynamic_id_variant(Variant & variant, id_type id) :
-        variant(variant),
-        id(id)
+private:
+    // Moves on to reading the rest of the current buffer in place.
+    constexpr void next_segment()
     {
+        while (m_index < m_segments.size() &&
+               m_offset == m_segments[m_index].size()) {
+            ++m_index;
+            m_offset = 0;
+        }
+
+        if (m_index == m_segments.size()) {
+            m_data = nullptr;
+            m_size = 0;
+            return;
+        }
+
+        auto segment = m_segments[m_index].subspan(m_offset);
+        m_data = segment.data();
+        m_size = segment.size();
+        advance(segment.size());
     }
 
-    ZPP_BITS_INLINE constexpr static auto serialize(auto & serializer,
-                                                    auto & self)
+    constexpr void advance(std::size_t count)
     {
-        return serializer.serialize_one(self.variant, self.id);
+        m_offset += count;
+        if (m_offset == m_segments[m_index].size()) {
+            ++m_index;
+            m_offset = 0;
+        }
     }
 
-    Variant & variant;
-    id_type id;
+    std::span<const std::span<const ByteType>> m_segments;
+    // The next byte of the chain that is not in place yet.
+    std::size_t m_index{};
+    std::size_t m_offset{};
+    const ByteType * m_data{};
+    std::size_t m_size{};
+    std::vector<ByteType> m_stitch;
 };
 
-template <typename Id, typename Variant>
-constexpr auto known_id(Id && id, Variant && variant)
-{
-    return known_dynamic_id_variant<Id, std::remove_reference_t<Variant>>(
-        variant, id);
-}
-
-template <typename Function>
-struct function_traits;
+template <typename Segments>
+segmented_buffer(Segments &&) -> segmented_buffer<std::remove_const_t<
+    typename std::remove_cvref_t<Segments>::value_type::element_type>>;
 
-template <typename Return, typename... Arguments>
-struct function_traits<Return(*)(Arguments...)>
+#if ZPP_BITS_HAS_MMAP
+// How a mapping is expected to be accessed, so that the kernel can read
+// ahead accordingly.
+enum class map_advice
 {
-    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
-    using return_type = Return;
+    normal,
+    sequential,
+    random,
+    willneed,
 };
 
-template <typename Return, typename... Arguments>
-struct function_traits<Return(*)(Arguments...) noexcept>
+// A read only memory mapping of an entire file, to be used as the view of
+// an input archive. The archive reads the file as it is paged in rather
+// than after it is read and copied into memory, and deserialized views of
+// const bytes, such as `std::span<const std::byte>`, or `std::string_view`
+// for `mapped_file<char>`, point directly into the mapping - so they are
+// valid for as long as the mapping is.
+template <typename ByteType = std::byte>
+class mapped_file
 {
-    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
-    using return_type = Return;
-};
+public:
+    using value_type = ByteType;
+    using advice = map_advice;
 
-template <typename This, typename Return, typename... Arguments>
-struct function_traits<Return(This::*)(Arguments...)>
-{
-    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
-    using return_type = Return;
-};
+    mapped_file() = default;
 
-template <typename This, typename Return, typename... Arguments>
-struct function_traits<Return(This::*)(Arguments...) noexcept>
-{
-    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
-    using return_type = Return;
-};
+    mapped_file(mapped_file && other) noexcept :
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0))
+    {
+    }
 
-template <typename This, typename Return, typename... Arguments>
-struct function_traits<Return(This::*)(Arguments...) const>
-{
-    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
-    using return_type = Return;
-};
+    mapped_file & operator=(mapped_file && other) noexcept
+    {
+        if (this != &other) {
+            close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
 
-template <typename This, typename Return, typename... Arguments>
-struct function_traits<Return(This::*)(Arguments...) const noexcept>
-{
-    using parameters_type = std::tuple<std::remove_cvref_t<Arguments>...>;
-    using return_type = Return;
-};
+    ~mapped_file()
+    {
+        close();
+    }
 
-template <typename Return>
-struct function_traits<Return(*)()>
-{
-    using parameters_type = void;
-    using return_type = Return;
-};
+    // Maps the file at `path`, replacing the current mapping if any.
+    errc open(const char * path, advice hint = advice::sequential)
+    {
+        close();
 
-template <typename Return>
-struct function_traits<Return(*)() noexcept>
-{
-    using parameters_type = void;
-    using return_type = Return;
-};
+        int fd;
+        do {
+            fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        } while (fd < 0 && errno == EINTR);
+        if (fd < 0) [[unlikely]] {
+            return std::errc(errno);
+        }
 
-template <typename This, typename Return>
-struct function_traits<Return(This::*)()>
-{
-    using parameters_type = void;
-    using return_type = Return;
-};
+        struct ::stat status;
+        if (::fstat(fd, &status) < 0) [[unlikely]] {
+            auto error = errno;
+            ::close(fd);
+            return std::errc(error);
+        }
 
-template <typename This, typename Return>
-struct function_traits<Return(This::*)() noexcept>
-{
-    using parameters_type = void;
-    using return_type = Return;
-};
+        if (!status.st_size) {
+            ::close(fd);
+            return {};
+        }
 
-template <typename This, typename Return>
-struct function_traits<Return(This::*)() const>
-{
-    using parameters_type = void;
-    using return_type = Return;
-};
+        auto data = ::mmap(nullptr,
+                           std::size_t(status.st_size),
+                           PROT_READ,
+                           MAP_PRIVATE,
+                           fd,
+                           0);
+        auto error = errno;
+        // The mapping holds on to the file on its own.
+        ::close(fd);
+        if (MAP_FAILED == data) [[unlikely]] {
+            return std::errc(error);
+        }
 
-template <typename This, typename Return>
-struct function_traits<Return(This::*)() const noexcept>
-{
-    using parameters_type = void;
-    using return_type = Return;
-};
+        m_data = static_cast<const ByteType *>(data);
+        m_size = std::size_t(status.st_size);
+        return advise(hint);
+    }
 
-template <typename Function>
-using function_parameters_t =
-    typename function_traits<std::remove_cvref_t<Function>>::parameters_type;
+    // Hints how the bytes from `offset` onwards, `size` bytes or up to the
+    // end, are going to be accessed.
+    errc advise(advice hint,
+                std::size_t offset = 0,
+                std::size_t size = std::numeric_limits<std::size_t>::max())
+    {
+        if (offset >= m_size) {
+            return {};
+        }
 
-template <typename Function>
-using function_return_type_t =
-    typename function_traits<std::remove_cvref_t<Function>>::return_type;
+        // Advice applies to whole pages.
+        auto page_size = std::size_t(::sysconf(_SC_PAGESIZE));
+        auto begin = offset / page_size * page_size;
+        size = std::min(size, m_size - offset) + (offset - begin);
 
-constexpr auto success(auto && value_or_errc) requires
-    std::same_as<decltype(value_or_errc.error()), errc>
-{
-    return value_or_errc.success();
-}
+        int value = MADV_NORMAL;
+        switch (hint) {
+        case advice::normal:
+            value = MADV_NORMAL;
+            break;
+        case advice::sequential:
+            value = MADV_SEQUENTIAL;
+            break;
+        case advice::random:
+            value = MADV_RANDOM;
+            break;
+        case advice::willneed:
+            value = MADV_WILLNEED;
+            break;
+        }
 
-constexpr auto failure(auto && value_or_errc) requires
-    std::same_as<decltype(value_or_errc.error()), errc>
-{
-    return value_or_errc.failure();
-}
+        if (::madvise(const_cast<ByteType *>(m_data) + begin, size, value) <
+            0) [[unlikely]] {
+            return std::errc(errno);
+        }
+        return {};
+    }
 
-template <typename Type>
-struct [[nodiscard]] value_or_errc
-{
-    using error_type = errc;
-    using value_type = std::conditional_t<
-        std::is_void_v<Type>,
-        std::nullptr_t,
-        std::conditional_t<
-            std::is_reference_v<Type>,
-            std::add_pointer_t<std::remove_reference_t<Type>>,
-            Type>>;
+    void close()
+    {
+        if (m_data) {
+            ::munmap(const_cast<ByteType *>(m_data), m_size);
+            m_data = nullptr;
+            m_size = 0;
+        }
+    }
 
-    constexpr value_or_errc() = default;
+    const ByteType * data() const
+    {
+        return m_data;
+    }
 
-    constexpr explicit value_or_errc(auto && value) :
-        m_return_value(std::forward<decltype(value)>(value))
+    std::size_t size() const
     {
+        return m_size;
     }
 
-    constexpr explicit value_or_errc(error_type error) :
-        m_error(std::forward<decltype(error)>(error)),
-        m_failure(true)
+    const ByteType * begin() const
     {
+        return m_data;
     }
 
-    constexpr value_or_errc(value_or_errc && other) noexcept
+    const ByteType * end() const
     {
-        if (other.success()) {
-            if constexpr (!std::is_void_v<Type>) {
-                if constexpr (!std::is_reference_v<Type>) {
-                    ::new (std::addressof(m_return_value))
-                        Type(std::move(other.m_return_value));
-                } else {
-                    m_return_value = other.m_return_value;
-                }
-            }
-        } else {
-            m_failure = other.m_failure;
-            std::memcpy(&m_error, &other.m_error, sizeof(m_error));
-        }
+        return m_data + m_size;
     }
 
-    constexpr ~value_or_errc()
+    const ByteType & operator[](std::size_t index) const
     {
-        if constexpr (!std::is_void_v<Type> &&
-                      !std::is_trivially_destructible_v<Type>) {
-            if (success()) {
-                m_return_value.~Type();
-            }
+        return m_data[index];
+    }
+
+private:
+    const ByteType * m_data{};
+    std::size_t m_size{};
+};
+
+// A file that is written through a shared memory mapping, to be used as
+// the view of an output archive. Growing the view grows the file and the
+// mapping together, as the archive enlarges it, so the output is serialized
+// straight into the file with no copy in memory and no call to write. The
+// disk blocks are reserved as the file grows, so that a full disk fails the
+// archive with `std::errc::no_space_on_device`.
+//
+// Unless the archive is given `zpp::bits::no_fit_size{}`, the file is
+// truncated to the position of the archive once it is done, as is done for
+// vectors. Otherwise, `resize()` it explicitly.
+template <typename ByteType = std::byte>
+class mapped_output_file
+{
+public:
+    using value_type = ByteType;
+
+    mapped_output_file() = default;
+
+    mapped_output_file(mapped_output_file && other) noexcept :
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)),
+        m_fd(std::exchange(other.m_fd, -1))
+    {
+    }
+
+    mapped_output_file & operator=(mapped_output_file && other) noexcept
+    {
+        if (this != &other) {
+            close();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_fd = std::exchange(other.m_fd, -1);
         }
+        return *this;
     }
 
-    constexpr bool success() const noexcept
+    ~mapped_output_file()
     {
-        return !m_failure;
+        close();
     }
 
-    constexpr bool failure() const noexcept
+    // Creates the file at `path`, or truncates it if it exists.
+    errc open(const char * path)
     {
-        return m_failure;
+        close();
+
+        do {
+            m_fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        } while (m_fd < 0 && errno == EINTR);
+        if (m_fd < 0) [[unlikely]] {
+            return std::errc(errno);
+        }
+        return {};
     }
 
-    constexpr decltype(auto) value() & noexcept
+    // Sets the size of the file and of the mapping to `size`.
+    errc resize(std::size_t size)
     {
-        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
-            return (m_return_value);
+        if (m_fd < 0) [[unlikely]] {
+            return std::errc::bad_file_descriptor;
+        }
+
+        if (size == m_size) {
+            return {};
+        }
+
+        // Shrinking unmaps the end before the file is truncated, growing
+        // grows the file before the mapping.
+        if (size < m_size) {
+            if (auto result = remap(size); failure(result)) [[unlikely]] {
+                return result;
+            }
         } else {
-            return (*m_return_value);
+            if (auto result = allocate(size); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+            return remap(size);
         }
+
+        return truncate(size);
     }
 
-    constexpr decltype(auto) value() && noexcept
+    // Writes the mapping back to the file, waiting for it to complete.
+    errc sync()
     {
-        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
-            return std::forward<Type>(m_return_value);
-        } else {
-            return std::forward<Type>(*m_return_value);
+        if (m_data && ::msync(m_data, m_size, MS_SYNC) < 0) [[unlikely]] {
+            return std::errc(errno);
         }
+        return {};
     }
 
-    constexpr decltype(auto) value() const & noexcept
+    void close()
     {
-        if constexpr (std::is_same_v<Type, decltype(m_return_value)>) {
-            return (m_return_value);
-        } else {
-            return (*m_return_value);
+        if (m_data) {
+            ::munmap(m_data, m_size);
+            m_data = nullptr;
+            m_size = 0;
+        }
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
         }
     }
 
-    constexpr auto error() const noexcept
+    ByteType * data()
     {
-        return m_error;
+        return m_data;
     }
 
-    #if __has_include("zpp_throwing.h")
-    constexpr zpp::throwing<Type> operator co_await() &&
+    const ByteType * data() const
     {
-        if (failure()) [[unlikely]] {
-            return error().code;
-        }
-        return std::move(*this).value();
+        return m_data;
     }
 
-    constexpr zpp::throwing<Type> operator co_await() const &
+    std::size_t size() const
     {
-        if (failure()) [[unlikely]] {
-            return error().code;
-        }
-        return value();
+        return m_size;
+    }
+
+    ByteType * begin()
+    {
+        return m_data;
+    }
+
+    ByteType * end()
+    {
+        return m_data + m_size;
+    }
+
+    ByteType & operator[](std::size_t index)
+    {
+        return m_data[index];
     }
-#endif
 
-    constexpr decltype(auto) or_throw() &
+private:
+    errc truncate(std::size_t size)
     {
-        if (failure()) [[unlikely]] {
-#ifdef __cpp_exceptions
-            throw std::system_error(std::make_error_code(error().code));
-#else
-            std::abort();
-#endif
+        int result;
+        do {
+            result = ::ftruncate(m_fd, ::off_t(size));
+        } while (result < 0 && errno == EINTR);
+        if (result < 0) [[unlikely]] {
+            return std::errc(errno);
         }
-        return value();
+        return {};
     }
 
-    constexpr decltype(auto) or_throw() &&
+    // Grows the file to `size` with the disk blocks reserved for it, as a
+    // store into a page of the mapping that the disk has no room for
+    // raises SIGBUS, rather than failing with
+    // `std::errc::no_space_on_device` here.
+    errc allocate(std::size_t size)
     {
-        if (failure()) [[unlikely]] {
-#ifdef __cpp_exceptions
-            throw std::system_error(std::make_error_code(error().code));
-#else
-            std::abort();
-#endif
+#if defined _POSIX_ADVISORY_INFO && _POSIX_ADVISORY_INFO > 0
+        int result;
+        do {
+            result = ::posix_fallocate(
+                m_fd, ::off_t(m_size), ::off_t(size - m_size));
+        } while (result == EINTR);
+        if (!result) [[likely]] {
+            return {};
         }
-        return std::move(*this).value();
+
+        // File systems that cannot reserve blocks are only grown.
+        if (result != EOPNOTSUPP && result != EINVAL) [[unlikely]] {
+            // Drop what was reserved before failing.
+            (void)truncate(m_size);
+            return std::errc(result);
+        }
+#endif
+        return truncate(size);
     }
 
-    constexpr decltype(auto) or_throw() const &
+    errc remap(std::size_t size)
     {
-        if (failure()) [[unlikely]] {
-#ifdef __cpp_exceptions
-            throw std::system_error(std::make_error_code(error().code));
+        void * data = MAP_FAILED;
+        if (!size) {
+            if (m_data) {
+                ::munmap(m_data, m_size);
+            }
+            m_data = nullptr;
+            m_size = 0;
+            return {};
+        } else if (!m_data) {
+            data = ::mmap(nullptr,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          m_fd,
+                          0);
+        } else {
+#ifdef MREMAP_MAYMOVE
+            data = ::mremap(m_data, m_size, size, MREMAP_MAYMOVE);
 #else
-            std::abort();
+            data = ::mmap(nullptr,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          m_fd,
+                          0);
+            if (MAP_FAILED != data) {
+                ::munmap(m_data, m_size);
+            }
 #endif
         }
-        return value();
+
+        if (MAP_FAILED == data) [[unlikely]] {
+            return std::errc(errno);
+        }
+
+        m_data = static_cast<ByteType *>(data);
+        m_size = size;
+        return {};
     }
 
-    union
-    {
-        error_type m_error{};
-        value_type m_return_value;
-    };
-    bool m_failure{};
+    ByteType * m_data{};
+    std::size_t m_size{};
+    int m_fd = -1;
 };
+#endif
 
 ZPP_BITS_INLINE constexpr auto
 apply(auto && function, auto && archive) requires(
@@ -4305,6 +8040,87 @@ struct rpc_impl
             return response<zpp::bits::id<Id, MaxSize>>();
         }
 
+        // Appends a request to a batch that the server serves as a whole
+        // with `serve_all()`. Each request is framed by the size of its id
+        // and arguments, so that the server can move on to the next request
+        // even if this one fails.
+        template <typename Id>
+        constexpr auto batch_request(auto &&... arguments) requires(
+            !std::remove_cvref_t<Out>::pinnable)
+        {
+            auto size_position = out.position();
+            if (auto result = out(std::uint32_t{}); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+
+            if (auto result = request<Id>(arguments...); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+
+            auto end = out.position();
+            out.position() = size_position;
+            auto result = out(std::uint32_t(end - size_position -
+                                            sizeof(std::uint32_t)));
+            out.position() = end;
+            return result;
+        }
+
+        template <auto Id, auto MaxSize = -1>
+        constexpr auto batch_request(auto &&... arguments)
+        {
+            return batch_request<zpp::bits::id<Id, MaxSize>>(arguments...);
+        }
+
+        // Reads the response to a request of a batch, in the order of the
+        // requests. The error of a request that failed is returned in
+        // place of its return value. If serving stopped early, the
+        // responses to the requests before the one that stopped it are
+        // still read here, and reading past them fails like truncated
+        // input.
+        template <typename Id>
+        constexpr auto batch_response()
+        {
+            using request_binding = decltype(binding<Id, Bindings...>());
+            using return_type = typename request_binding::return_type;
+
+            std::errc status{};
+            auto result = in(status);
+
+            // Bindings that return nothing, or return an error alone, are
+            // answered with their status alone.
+            if constexpr (std::is_void_v<return_type> ||
+                          std::same_as<return_type, errc>) {
+                if (failure(result)) [[unlikely]] {
+                    return result;
+                }
+                return errc{status};
+            } else {
+                using response_type = decltype(response<Id>());
+                if constexpr (std::is_void_v<response_type>) {
+                    if (failure(result)) [[unlikely]] {
+                        return result;
+                    }
+                    return errc{status};
+                } else {
+                    if (failure(result)) [[unlikely]] {
+                        return response_type{result};
+                    }
+                    if (status != std::errc{}) [[unlikely]] {
+                        return response_type{errc{status}};
+                    }
+                    return response<Id>();
+                }
+            }
+        }
+
+        template <auto Id, auto MaxSize = -1>
+        constexpr auto batch_response()
+        {
+            return batch_response<zpp::bits::id<Id, MaxSize>>();
+        }
+
         In & in;
         Out & out;
     };
@@ -4338,79 +8154,73 @@ struct rpc_impl
             static_assert(std::remove_cvref_t<decltype(out)>::kind() == kind::out);
         }
 
-        template <typename FirstBinding, typename... OtherBindings>
-        ZPP_BITS_INLINE constexpr auto
-        call_binding(auto & id) requires(!FirstBinding::opaque)
+        template <typename Binding>
+        ZPP_BITS_INLINE constexpr auto call() requires(!Binding::opaque)
         {
-            if (FirstBinding::id::value == id) {
-                if constexpr (std::is_void_v<decltype(FirstBinding::call(
-                                  in, context))>) {
-                    FirstBinding::call(in, context);
-                    return errc{};
-                } else if constexpr (std::same_as<
-                                         decltype(FirstBinding::call(
-                                             in, context)),
-                                         errc>) {
-                    if (auto result = FirstBinding::call(in, context);
-                        failure(result)) [[unlikely]] {
-                        return result;
-                    }
-                    return errc{};
-                } else if constexpr (std::is_void_v<typename FirstBinding::
-                                                        parameters_type>) {
-                    return out(FirstBinding::call(in, context));
-                } else {
-                    if (auto result = FirstBinding::call(in, context);
-                        failure(result)) [[unlikely]] {
-                        return result.error();
-                    } else {
-                        return out(result.value());
-                    }
+            if constexpr (std::is_void_v<decltype(Binding::call(in,
+                                                                context))>) {
+                Binding::call(in, context);
+                return errc{};
+            } else if constexpr (std::same_as<decltype(Binding::call(
+                                                  in, context)),
+                                              errc>) {
+                if (auto result = Binding::call(in, context);
+                    failure(result)) [[unlikely]] {
+                    return result;
                 }
+                return errc{};
+            } else if constexpr (std::is_void_v<
+                                     typename Binding::parameters_type>) {
+                return out(Binding::call(in, context));
             } else {
-                if constexpr (!sizeof...(OtherBindings)) {
-                    return errc{std::errc::not_supported};
+                if (auto result = Binding::call(in, context);
+                    failure(result)) [[unlikely]] {
+                    return result.error();
                 } else {
-                    return call_binding<OtherBindings...>(id);
+                    return out(result.value());
                 }
             }
         }
 
-        template <typename FirstBinding, typename... OtherBindings>
-        ZPP_BITS_INLINE constexpr auto
-        call_binding(auto & id) requires FirstBinding::opaque
+        template <typename Binding>
+        ZPP_BITS_INLINE constexpr auto call() requires Binding::opaque
         {
-            if (FirstBinding::id::value == id) {
-                if constexpr (std::is_void_v<decltype(FirstBinding::call(
-                                  in, out, context))>) {
-                    FirstBinding::call(in, out, context);
-                    return errc{};
-                } else if constexpr (std::same_as<
-                                         decltype(FirstBinding::call(
-                                             in, out, context)),
-                                         errc>) {
-                    if (auto result = FirstBinding::call(in, out, context);
-                        failure(result)) [[unlikely]] {
-                        return result;
-                    }
-                    return errc{};
-                } else if constexpr (
-                    requires {
-                        requires std::same_as<
-                            typename decltype(FirstBinding::call(
-                                in, out, context))::value_type,
-                            value_or_errc<decltype(FirstBinding::call(
-                                in, out, context))>>;
-                    }) {
-                    if (auto result = FirstBinding::call(in, out, context);
-                        failure(result)) [[unlikely]] {
-                        return result.error();
-                    } else {
-                        return out(result.value());
-                    }
+            if constexpr (std::is_void_v<decltype(Binding::call(
+                              in, out, context))>) {
+                Binding::call(in, out, context);
+                return errc{};
+            } else if constexpr (std::same_as<decltype(Binding::call(
+                                                  in, out, context)),
+                                              errc>) {
+                if (auto result = Binding::call(in, out, context);
+                    failure(result)) [[unlikely]] {
+                    return result;
+                }
+                return errc{};
+            } else if constexpr (
+                requires {
+                    requires std::same_as<
+                        typename decltype(Binding::call(
+                            in, out, context))::value_type,
+                        value_or_errc<decltype(Binding::call(
+                            in, out, context))>>;
+                }) {
+                if (auto result = Binding::call(in, out, context);
+                    failure(result)) [[unlikely]] {
+                    return result.error();
                 } else {
-                    return out(FirstBinding::call(in, out, context));
+                    return out(result.value());
                 }
+            } else {
+                return out(Binding::call(in, out, context));
+            }
+        }
+
+        template <typename FirstBinding, typename... OtherBindings>
+        ZPP_BITS_INLINE constexpr auto call_binding(auto & id)
+        {
+            if (FirstBinding::id::value == id) {
+                return call<FirstBinding>();
             } else {
                 if constexpr (!sizeof...(OtherBindings)) {
                     return errc{std::errc::not_supported};
@@ -4421,128 +8231,117 @@ struct rpc_impl
         }
 
 #if __has_include("zpp_throwing.h")
-        template <typename FirstBinding, typename... OtherBindings>
-        zpp::throwing<void>
-        call_binding_throwing(auto & id) requires(!FirstBinding::opaque)
+        template <typename Binding>
+        zpp::throwing<void> call_throwing() requires(!Binding::opaque)
         {
-            if (FirstBinding::id::value == id) {
-                if constexpr (std::is_void_v<decltype(FirstBinding::call(
-                                  in, context))>) {
-                    FirstBinding::call(in, context);
-                    co_return;
-                } else if constexpr (std::same_as<
-                                         decltype(FirstBinding::call(
-                                             in, context)),
-                                         errc>) {
-                    if (auto result = FirstBinding::call(in, context);
-                        failure(result)) [[unlikely]] {
-                        co_yield result.code;
-                    }
-                    co_return;
-                } else if constexpr (std::is_void_v<typename FirstBinding::
-                                                        parameters_type>) {
-                    if constexpr (requires {
-                                      FirstBinding::call(in, context)
-                                          .await_ready();
-                                  }) {
-                        if constexpr (std::is_void_v<
-                                          decltype(FirstBinding::call(
-                                                       in, context)
-                                                       .await_resume())>) {
-                            co_await FirstBinding::call(in, context);
-                        } else {
-                            co_await out(
-                                co_await FirstBinding::call(in, context));
-                        }
+            if constexpr (std::is_void_v<decltype(Binding::call(in,
+                                                                context))>) {
+                Binding::call(in, context);
+                co_return;
+            } else if constexpr (std::same_as<decltype(Binding::call(
+                                                  in, context)),
+                                              errc>) {
+                if (auto result = Binding::call(in, context);
+                    failure(result)) [[unlikely]] {
+                    co_yield result.code;
+                }
+                co_return;
+            } else if constexpr (std::is_void_v<
+                                     typename Binding::parameters_type>) {
+                if constexpr (requires {
+                                  Binding::call(in, context).await_ready();
+                              }) {
+                    if constexpr (std::is_void_v<
+                                      decltype(Binding::call(in, context)
+                                                   .await_resume())>) {
+                        co_await Binding::call(in, context);
                     } else {
-                        co_await out(FirstBinding::call(in, context));
+                        co_await out(co_await Binding::call(in, context));
                     }
                 } else {
-                    if (auto result = FirstBinding::call(in, context);
-                        failure(result)) [[unlikely]] {
-                        co_yield result.error().code;
-                    } else if constexpr (requires {
-                                             result.value().await_ready();
-                                         }) {
-                        if constexpr (!std::is_void_v<
-                                          decltype(result.value()
-                                                       .await_resume())>) {
-                            co_await out(co_await result.value());
-                        }
-                        co_return;
-                    } else {
-                        co_await out(result.value());
-                    }
+                    co_await out(Binding::call(in, context));
                 }
             } else {
-                if constexpr (!sizeof...(OtherBindings)) {
-                    co_yield std::errc::not_supported;
+                if (auto result = Binding::call(in, context);
+                    failure(result)) [[unlikely]] {
+                    co_yield result.error().code;
+                } else if constexpr (requires {
+                                         result.value().await_ready();
+                                     }) {
+                    if constexpr (!std::is_void_v<
+                                      decltype(result.value()
+                                                   .await_resume())>) {
+                        co_await out(co_await result.value());
+                    }
+                    co_return;
                 } else {
-                    co_return co_await call_binding_throwing<
-                        OtherBindings...>(id);
+                    co_await out(result.value());
                 }
             }
         }
 
-        template <typename FirstBinding, typename... OtherBindings>
-        zpp::throwing<void>
-        call_binding_throwing(auto & id) requires FirstBinding::opaque
+        template <typename Binding>
+        zpp::throwing<void> call_throwing() requires Binding::opaque
         {
-            if (FirstBinding::id::value == id) {
-                if constexpr (std::is_void_v<decltype(FirstBinding::call(
-                                  in, out, context))>) {
-                    FirstBinding::call(in, out, context);
-                    co_return;
-                } else if constexpr (std::same_as<
-                                         decltype(FirstBinding::call(
-                                             in, out, context)),
-                                         errc>) {
-                    if (auto result = FirstBinding::call(in, out, context);
-                        failure(result)) [[unlikely]] {
-                        co_yield result.code;
+            if constexpr (std::is_void_v<decltype(Binding::call(
+                              in, out, context))>) {
+                Binding::call(in, out, context);
+                co_return;
+            } else if constexpr (std::same_as<decltype(Binding::call(
+                                                  in, out, context)),
+                                              errc>) {
+                if (auto result = Binding::call(in, out, context);
+                    failure(result)) [[unlikely]] {
+                    co_yield result.code;
+                }
+                co_return;
+            } else if constexpr (
+                requires {
+                    requires std::same_as<
+                        typename decltype(Binding::call(
+                            in, out, context))::value_type,
+                        value_or_errc<decltype(Binding::call(
+                            in, out, context))>>;
+                }) {
+                if (auto result = Binding::call(in, out, context);
+                    failure(result)) [[unlikely]] {
+                    co_yield result.error().code;
+                } else if constexpr (requires {
+                                         result.value().await_ready();
+                                     }) {
+                    if constexpr (!std::is_void_v<
+                                      decltype(result.value()
+                                                   .await_resume())>) {
+                        co_await out(co_await result.value());
                     }
                     co_return;
-                } else if constexpr (
-                    requires {
-                        requires std::same_as<
-                            typename decltype(FirstBinding::call(
-                                in, out, context))::value_type,
-                            value_or_errc<decltype(FirstBinding::call(
-                                in, out, context))>>;
-                    }) {
-                    if (auto result = FirstBinding::call(in, out, context);
-                        failure(result)) [[unlikely]] {
-                        co_yield result.error().code;
-                    } else if constexpr (requires {
-                                             result.value().await_ready();
-                                         }) {
-                        if constexpr (!std::is_void_v<
-                                          decltype(result.value()
-                                                       .await_resume())>) {
-                            co_await out(co_await result.value());
-                        }
-                        co_return;
-                    } else {
-                        co_await out(result.value());
-                    }
                 } else {
-                    if constexpr (requires {
-                                      FirstBinding::call(in, out, context)
-                                          .await_ready();
-                                  }) {
-                        if constexpr (std::is_void_v<
-                                          decltype(FirstBinding::call(
-                                                       in, out, context)
-                                                       .await_resume())>) {
-                            co_await FirstBinding::call(in, out, context);
-                        } else {
-                            co_await out(
-                                co_await FirstBinding::call(in, out, context));
-                        }
+                    co_await out(result.value());
+                }
+            } else {
+                if constexpr (requires {
+                                  Binding::call(in, out, context)
+                                      .await_ready();
+                              }) {
+                    if constexpr (std::is_void_v<
+                                      decltype(Binding::call(in, out, context)
+                                                   .await_resume())>) {
+                        co_await Binding::call(in, out, context);
                     } else {
-                        co_await out(FirstBinding::call(in, out, context));
+                        co_await out(
+                            co_await Binding::call(in, out, context));
                     }
+                } else {
+                    co_await out(Binding::call(in, out, context));
                 }
+            }
+        }
+
+        template <typename FirstBinding, typename... OtherBindings>
+        zpp::throwing<void> call_binding_throwing(auto & id)
+        {
+            if (FirstBinding::id::value == id) {
+                co_return co_await call_throwing<FirstBinding>();
             } else {
                 if constexpr (!sizeof...(OtherBindings)) {
                     co_yield std::errc::not_supported;
@@ -4552,20 +8351,65 @@ struct rpc_impl
                 }
             }
         }
+
+        zpp::throwing<void> not_supported_throwing()
+        {
+            co_yield std::errc::not_supported;
+        }
 #endif
 
+        // Servers of more than a few bindings of integral ids call the
+        // binding through a table indexed by the position of its id among
+        // those of all bindings, rather than comparing the id against each
+        // of them in turn.
+        constexpr static bool dispatches_through_table =
+            sizeof...(Bindings) > 4 && (std::is_integral_v<rpc_impl::id> ||
+                                        std::is_enum_v<rpc_impl::id>);
+
+        ZPP_BITS_INLINE constexpr static std::size_t
+        binding_index(rpc_impl::id id)
+        {
+            using index = traits::key_index<
+                std::array<std::uint64_t, sizeof...(Bindings)>{
+                    std::uint64_t(Bindings::id::value)...}>;
+            return index::find(std::uint64_t(id));
+        }
+
         constexpr auto serve(auto && id)
         {
+            constexpr auto through_table =
+                dispatches_through_table &&
+                std::same_as<std::remove_cvref_t<decltype(id)>, rpc_impl::id>;
 #if __has_include("zpp_throwing.h")
             if constexpr ((... || requires {
                               std::declval<
                                   typename Bindings::return_type>()
                                   .await_ready();
                           })) {
-                return call_binding_throwing<Bindings...>(id);
+                if constexpr (through_table) {
+                    constexpr std::array calls{
+                        &server::call_throwing<Bindings>...};
+                    if (auto index = binding_index(id);
+                        index < sizeof...(Bindings)) [[likely]] {
+                        return (this->*calls[index])();
+                    }
+                    return not_supported_throwing();
+                } else {
+                    return call_binding_throwing<Bindings...>(id);
+                }
             } else {
 #endif
-                return call_binding<Bindings...>(id);
+                if constexpr (through_table) {
+                    constexpr std::array calls{&server::call<Bindings>...};
+                    if (auto index = binding_index(id);
+                        index < sizeof...(Bindings)) [[likely]] {
+                        return (this->*calls[index])();
+                    }
+                    return decltype((this->*calls[0])()){
+                        std::errc::not_supported};
+                } else {
+                    return call_binding<Bindings...>(id);
+                }
 #if __has_include("zpp_throwing.h")
             }
 #endif
@@ -4581,6 +8425,109 @@ struct rpc_impl
             return serve(id);
         }
 
+        // Serves the requests of a batch written by the client with
+        // `batch_request()` until the input that is available when called
+        // is drained, or until the source ends for an input that is
+        // refilled from one, writing the responses in the order of the
+        // requests.
+        // Each response begins with the status of its request. A request is
+        // read from its frame alone, failing like truncated input if it
+        // reads past the frame, and with `std::errc::message_size` if it
+        // leaves some of the frame unread. The frame shares the positions
+        // of the input, so that arguments are aligned as outside of a
+        // batch, and follows its storage if writing the output moves it.
+        // A request that fails is answered with its error alone, whatever
+        // the binding wrote before failing, and serving goes on from the
+        // next frame. Only a frame that does not fit the input, or a status
+        // that does not fit the output, stops the batch, keeping the
+        // responses written before it.
+        constexpr errc serve_all() requires(
+            !std::remove_cvref_t<Out>::pinnable &&
+            std::same_as<decltype(serve()), errc>)
+        {
+            using in_type = std::remove_cvref_t<In>;
+            using out_type = std::remove_cvref_t<Out>;
+
+            auto batch_end = in.position() + in.remaining_data().size();
+            while (true) {
+                // A refill moves the positions of the input, so the end of
+                // the batch is where the source ends instead.
+                if constexpr (in_type::refillable) {
+                    if (auto result = in.refill(sizeof(std::uint32_t));
+                        failure(result)) [[unlikely]] {
+                        return result;
+                    }
+                    if (in.remaining_data().empty()) {
+                        break;
+                    }
+                } else if (in.position() >= batch_end) {
+                    break;
+                }
+
+                std::uint32_t size{};
+                if (auto result = in(size); failure(result)) [[unlikely]] {
+                    return result;
+                }
+
+                // The request is read from the window as a whole.
+                if constexpr (in_type::refillable) {
+                    if (auto result = in.fill_for(size); failure(result))
+                        [[unlikely]] {
+                        return result;
+                    }
+                } else if (size > batch_end - in.position()) [[unlikely]] {
+                    return std::errc::result_out_of_range;
+                }
+
+                auto frame = in.frame(size);
+                if (failure(frame)) [[unlikely]] {
+                    return frame.error();
+                }
+                auto & request = frame.value();
+                auto request_end = in.position() + size;
+                in.position() = request_end;
+
+                auto status_position = out.position();
+                if (auto result = out(std::errc{}); failure(result))
+                    [[unlikely]] {
+                    return result;
+                }
+
+                auto result =
+                    server<decltype(request), Out &, Context &>{
+                        request, out, context}
+                        .serve();
+                if (!failure(result) && request.position() != request_end)
+                    [[unlikely]] {
+                    result = std::errc::message_size;
+                }
+
+                if (failure(result)) [[unlikely]] {
+                    out.position() = status_position;
+                    if (auto written = out(result.code); failure(written))
+                        [[unlikely]] {
+                        return written;
+                    }
+
+                    // Drop what the binding wrote past the status.
+                    if constexpr (out_type::resizable) {
+                        if (out.position() < out.data().size()) {
+                            if constexpr (out_type::fallible_resize) {
+                                if (auto resized =
+                                        out.data().resize(out.position());
+                                    failure(resized)) [[unlikely]] {
+                                    return resized;
+                                }
+                            } else {
+                                out.data().resize(out.position());
+                            }
+                        }
+                    }
+                }
+            }
+            return {};
+        }
+
         In & in;
         Out & out;
         [[no_unique_address]] Context context;
@@ -5000,6 +8947,10 @@ struct pb
                 // archive; the level itself is counted by the caller.
                 out.nesting_depth() = archive.nesting_depth();
             }
+            if constexpr (archive_type::pinnable) {
+                // Bytes pinned by the caller must stay in place as well.
+                out.pin_count() = archive.pin_count();
+            }
             if constexpr (concepts::self_referencing<type>) {
                 auto result = visit_members(
                     item,
@@ -5223,23 +9174,50 @@ struct pb
     {
         using archive_type = std::remove_cvref_t<decltype(archive)>;
 
+        if constexpr (archive_type::refillable) {
+            // Fields are read from the window, so the whole message has to
+            // be in it.
+            if (size == std::numeric_limits<std::size_t>::max()) {
+                if (auto result = archive.refill(archive_type::allocation_limit);
+                    failure(result)) [[unlikely]] {
+                    return result;
+                }
+            } else if (size > archive_type::allocation_limit) [[unlikely]] {
+                return std::errc::message_size;
+            } else if (auto result = archive.fill_for(size); failure(result))
+                [[unlikely]] {
+                return result;
+            }
+        }
+
         auto data = archive.remaining_data();
-        in in{std::span{data.data(), std::min(size, data.size())},
-              size_varint{},
-              endian::little{},
-              alloc_limit<archive_type::allocation_limit>{},
-              nesting_limit<archive_type::nesting_depth_limit>{}};
+        auto read = [&](auto &&... options) ZPP_BITS_CONSTEXPR_INLINE_LAMBDA {
+            in in{std::span{data.data(), std::min(size, data.size())},
+                  size_varint{},
+                  endian::little{},
+                  alloc_limit<archive_type::allocation_limit>{},
+                  nesting_limit<archive_type::nesting_depth_limit>{},
+                  std::move(options)...};
+
+            // Each nested message is read through a fresh archive, so the
+            // depth reached so far has to travel with it; the level itself
+            // is counted by the caller.
+            if constexpr (archive_type::nesting_limited) {
+                in.nesting_depth() = archive.nesting_depth();
+            }
 
-        // Each nested message is read through a fresh archive, so the depth
-        // reached so far has to travel with it; the level itself is counted
-        // by the caller.
-        if constexpr (archive_type::nesting_limited) {
-            in.nesting_depth() = archive.nesting_depth();
-        }
+            auto result = deserialize_fields(in, item);
+            archive.position() += in.position();
+            return result;
+        };
 
-        auto result = deserialize_fields(in, item);
-        archive.position() += in.position();
-        return result;
+        // So does the memory resource, so that the fields of the message
+        // are allocated from it as well.
+        if constexpr (archive_type::has_memory_resource) {
+            return read(memory_resource{archive.resource()});
+        } else {
+            return read();
+        }
     }
 
     ZPP_BITS_INLINE constexpr static errc
@@ -5249,15 +9227,19 @@ struct pb
         static_assert(check_type<type>());
 
         auto size = archive.data().size();
+
+        // Repeated fields append to their container, so it is switched to
+        // the memory resource of the archive once, ahead of the message.
         visit_members(
-            item, [](auto &&... members) ZPP_BITS_CONSTEXPR_INLINE_LAMBDA {
+            item, [&](auto &&... members) ZPP_BITS_CONSTEXPR_INLINE_LAMBDA {
                 (
-                    [](auto && member) ZPP_BITS_CONSTEXPR_INLINE_LAMBDA {
+                    [&](auto && member) ZPP_BITS_CONSTEXPR_INLINE_LAMBDA {
                         using type = std::remove_cvref_t<decltype(member)>;
                         if constexpr (concepts::container<type> &&
                                       !std::is_fundamental_v<type> &&
                                       !std::same_as<type, std::byte> &&
                                       requires { member.clear(); }) {
+                            archive.use_memory_resource(member);
                             member.clear();
                         }
                     }(members),
@@ -5476,11 +9458,35 @@ struct pb
                     item.resize(length / sizeof(value_type));
                     return archive(unsized(item));
                 } else {
-                    if constexpr (requires { item.reserve(1); }) {
+                    auto end_position = length + archive.position();
+                    if constexpr (concepts::varint<value_type> &&
+                                  requires { item.resize(1); } &&
+                                  std::contiguous_iterator<
+                                      decltype(item.begin())>) {
+                        // The varints that end within the field are read
+                        // as a run, as many as there are last bytes.
+                        auto data = archive.remaining_data();
+                        auto available =
+                            std::min(std::size_t(length), data.size());
+                        std::size_t count{};
+                        for (std::size_t i = 0; i < available; ++i) {
+                            count += !(std::to_integer<unsigned char>(
+                                           std::byte(data[i])) &
+                                       0x80);
+                        }
+
+                        auto size = item.size();
+                        item.resize(size + count);
+                        if (auto result = archive(unsized(std::span{
+                                std::to_address(item.begin()) + size,
+                                count}));
+                            failure(result)) [[unlikely]] {
+                            return result;
+                        }
+                    } else if constexpr (requires { item.reserve(1); }) {
                         item.reserve(length);
                     }
 
-                    auto end_position = length + archive.position();
                     while (archive.position() < end_position) {
                         if (auto result = fetch(); failure(result))
                             [[unlikely]] {